@@ -0,0 +1,158 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include <Mapping.hpp>
+
+// Compile-time id of a class of a closed hierarchy. Either declare
+// `static constexpr std::size_t kTypeId` in the class or specialize the trait.
+template <class T>
+struct TypeIdOf {
+  static constexpr std::size_t value = T::kTypeId;
+};
+
+// Root of a closed hierarchy: stores the id of the most derived class, so
+// reading the dynamic type is a single load and needs no RTTI.
+class TypeIdRoot {
+ public:
+  std::size_t typeId() const noexcept {
+    return type_id_;
+  }
+
+ protected:
+  TypeIdRoot() = default;
+
+  // The id belongs to the object, not to its value.
+  TypeIdRoot(const TypeIdRoot&) noexcept {
+  }
+
+  TypeIdRoot& operator=(const TypeIdRoot&) noexcept {
+    return *this;
+  }
+
+  ~TypeIdRoot() = default;
+
+ protected:
+  std::size_t type_id_ = 0;
+};
+
+namespace detail {
+
+// Exposes the protected copy and move constructors of a class in the
+// hierarchy, so that traits can tell whether they throw.
+template <class Parent>
+struct ExposedConstructors : Parent {};
+
+}  // namespace detail
+
+// CRTP helper: `struct Dog : WithTypeId<Dog, Animal> { ... };`. Every
+// constructor overwrites the id, the most derived one runs last.
+template <class Derived, class Parent = TypeIdRoot>
+class WithTypeId : public Parent {
+ protected:
+  WithTypeId() {
+    setTypeId();
+  }
+
+  template <class... Args>
+  explicit WithTypeId(std::in_place_t, Args&&... args)
+      : Parent(std::forward<Args>(args)...) {
+    setTypeId();
+  }
+
+  WithTypeId(const WithTypeId& other) noexcept(
+      std::is_nothrow_copy_constructible_v<
+          detail::ExposedConstructors<Parent>>)
+      : Parent(other) {
+    setTypeId();
+  }
+
+  WithTypeId(WithTypeId&& other) noexcept(
+      std::is_nothrow_move_constructible_v<
+          detail::ExposedConstructors<Parent>>)
+      : Parent(std::move(other)) {
+    setTypeId();
+  }
+
+  WithTypeId& operator=(const WithTypeId& other) = default;
+  WithTypeId& operator=(WithTypeId&& other) = default;
+
+ private:
+  void setTypeId() noexcept {
+    this->type_id_ = TypeIdOf<Derived>::value;
+  }
+};
+
+// The complete list of classes the mapper may be called with.
+template <class... Classes>
+struct ClosedHierarchy {};
+
+namespace detail {
+
+template <class C, class Best, class... Maps>
+struct MostDerivedMapping {
+  using Type = Best;
+};
+
+template <class C, class Best, class Map, class... Maps>
+struct MostDerivedMapping<C, Best, Map, Maps...>
+    : MostDerivedMapping<
+          C,
+          std::conditional_t<std::derived_from<C, typename Map::Type> &&
+                                 std::derived_from<typename Map::Type,
+                                                   typename Best::Type>,
+                             Map, Best>,
+          Maps...> {};
+
+}  // namespace detail
+
+template <class Base, class Target, class Hierarchy, class... Mappings>
+class ClosedPolymorphicMapper;
+
+// PolymorphicMapper for hierarchies built without RTTI: the most derived
+// mapping of every class is resolved at compile time into a table indexed
+// by TypeIdOf, and map() is a lookup by `object.typeId()`. Ids past the
+// largest one in the hierarchy map to std::nullopt.
+template <class Base, class Target, class... Classes, class... Mappings>
+  requires((std::derived_from<typename Mappings::Type, Base> &&
+            std::same_as<decltype(Mappings::Target), const Target>) &&
+           ...) &&
+          (std::derived_from<Classes, Base> && ...) &&
+          requires(const Base& object) {
+            { object.typeId() } -> std::convertible_to<std::size_t>;
+          }
+class ClosedPolymorphicMapper<Base, Target, ClosedHierarchy<Classes...>,
+                              Mappings...> {
+  static constexpr std::size_t kTableSize =
+      std::max({std::size_t{0}, (TypeIdOf<Classes>::value + 1)...});
+
+  static_assert(
+      [] {
+        std::array<std::size_t, sizeof...(Classes)> ids = {
+            TypeIdOf<Classes>::value...};
+        std::sort(ids.begin(), ids.end());
+        return std::adjacent_find(ids.begin(), ids.end()) == ids.end();
+      }(),
+      "classes of a ClosedHierarchy must have distinct type ids");
+
+  static constexpr auto table_ = [] {
+    std::array<std::optional<Target>, kTableSize> table{};
+    ((table[TypeIdOf<Classes>::value] =
+          detail::MostDerivedMapping<Classes, Mapping<Base, std::nullopt>,
+                                     Mappings...>::Type::Target),
+     ...);
+    return table;
+  }();
+
+ public:
+  static constexpr std::optional<Target> map(const Base& object) {
+    std::size_t id = object.typeId();
+    return id < kTableSize ? table_[id] : std::nullopt;
+  }
+};
@@ -0,0 +1,242 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include <FixedString.hpp>
+
+namespace detail {
+
+static constexpr std::size_t kVectorSize = 16;
+static constexpr std::size_t kWideVectorSize = 32;
+
+constexpr bool isAlpha(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+// Literal bytes and case masks are laid out at compile time, so comparing
+// against runtime input is a fixed sequence of loads, ORs and compares.
+// Inputs are never read past `literal.length` bytes: tails are covered by
+// overlapping loads instead of a byte loop.
+template <FixedString<256> literal, bool ignore_case>
+struct Pattern {
+  static constexpr std::size_t size = literal.length;
+  static constexpr std::size_t padded_size =
+      (size + kWideVectorSize - 1) / kWideVectorSize * kWideVectorSize;
+
+  // Setting bit 5 folds ASCII case, so only letters get a mask bit.
+  alignas(kWideVectorSize) static constexpr std::array<char, padded_size>
+      mask = [] {
+        std::array<char, padded_size> result{};
+        for (std::size_t i = 0; i < size; ++i) {
+          result[i] = ignore_case && isAlpha(literal.string[i]) ? 0x20 : 0;
+        }
+        return result;
+      }();
+
+  alignas(kWideVectorSize) static constexpr std::array<char, padded_size>
+      bytes = [] {
+        std::array<char, padded_size> result{};
+        for (std::size_t i = 0; i < size; ++i) {
+          result[i] = static_cast<char>(literal.string[i] | mask[i]);
+        }
+        return result;
+      }();
+
+  static constexpr bool matchesScalar(const char* input) {
+    for (std::size_t i = 0; i < size; ++i) {
+      if (static_cast<char>(input[i] | mask[i]) != bytes[i]) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  template <class Word, std::size_t offset>
+  static bool matchesWord(const char* input) {
+    constexpr auto expected = [] {
+      std::array<char, sizeof(Word)> chunk{};
+      for (std::size_t i = 0; i < sizeof(Word); ++i) {
+        chunk[i] = bytes[offset + i];
+      }
+      return std::bit_cast<Word>(chunk);
+    }();
+    constexpr auto word_mask = [] {
+      std::array<char, sizeof(Word)> chunk{};
+      for (std::size_t i = 0; i < sizeof(Word); ++i) {
+        chunk[i] = mask[offset + i];
+      }
+      return std::bit_cast<Word>(chunk);
+    }();
+
+    Word word;
+    std::memcpy(&word, input + offset, sizeof(Word));
+    return static_cast<Word>(word | word_mask) == expected;
+  }
+
+  // Two overlapping words cover any size up to twice the word size.
+  template <class Word>
+  static bool matchesShort(const char* input) {
+    if constexpr (size == sizeof(Word)) {
+      return matchesWord<Word, 0>(input);
+    } else {
+      return matchesWord<Word, 0>(input) &
+             matchesWord<Word, size - sizeof(Word)>(input);
+    }
+  }
+
+#if defined(__SSE2__)
+  template <std::size_t... offsets>
+  static bool matchesVectors(const char* input,
+                             std::index_sequence<offsets...>) {
+    auto load = [input](std::size_t offset) {
+      auto chunk = _mm_loadu_si128(
+          reinterpret_cast<const __m128i*>(input + offset));
+      chunk = _mm_or_si128(
+          chunk,
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(mask.data() +
+                                                           offset)));
+      return _mm_cmpeq_epi8(
+          chunk, _mm_loadu_si128(
+                     reinterpret_cast<const __m128i*>(bytes.data() + offset)));
+    };
+
+    auto equal = _mm_set1_epi8(-1);
+    ((equal = _mm_and_si128(equal, load(offsets))), ...);
+    return _mm_movemask_epi8(equal) == 0xFFFF;
+  }
+#endif
+
+#if defined(__AVX2__)
+  template <std::size_t... offsets>
+  static bool matchesWideVectors(const char* input,
+                                 std::index_sequence<offsets...>) {
+    auto load = [input](std::size_t offset) {
+      auto chunk = _mm256_loadu_si256(
+          reinterpret_cast<const __m256i*>(input + offset));
+      chunk = _mm256_or_si256(
+          chunk,
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(mask.data() +
+                                                              offset)));
+      return _mm256_cmpeq_epi8(
+          chunk, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(
+                     bytes.data() + offset)));
+    };
+
+    auto equal = _mm256_set1_epi8(-1);
+    ((equal = _mm256_and_si256(equal, load(offsets))), ...);
+    return _mm256_movemask_epi8(equal) == -1;
+  }
+#endif
+
+  // Offsets of `block`-sized loads covering [0, size); the last one is
+  // shifted back to end exactly at `size`.
+  template <std::size_t block, std::size_t... is>
+  static constexpr auto blockOffsets(std::index_sequence<is...>) {
+    return std::index_sequence<(is * block + block <= size ? is * block
+                                                           : size - block)...>{};
+  }
+
+  template <std::size_t block>
+  static constexpr auto blockOffsets() {
+    return blockOffsets<block>(
+        std::make_index_sequence<(size + block - 1) / block>{});
+  }
+
+  // `input` must point to at least `size` readable bytes.
+  static constexpr bool matches(const char* input) {
+    if (std::is_constant_evaluated()) {
+      return matchesScalar(input);
+    }
+
+    if constexpr (size == 0) {
+      return true;
+    } else if constexpr (size == 1) {
+      return matchesWord<std::uint8_t, 0>(input);
+    } else if constexpr (size < 4) {
+      return matchesShort<std::uint16_t>(input);
+    } else if constexpr (size < 8) {
+      return matchesShort<std::uint32_t>(input);
+    } else if constexpr (size < kVectorSize) {
+      return matchesShort<std::uint64_t>(input);
+    } else {
+#if defined(__AVX2__)
+      if constexpr (size >= kWideVectorSize) {
+        return matchesWideVectors(input, blockOffsets<kWideVectorSize>());
+      }
+#endif
+#if defined(__SSE2__)
+      return matchesVectors(input, blockOffsets<kVectorSize>());
+#else
+      return matchesScalar(input);
+#endif
+    }
+  }
+};
+
+template <bool ignore_case, FixedString<256>... literals>
+constexpr std::optional<std::size_t> matchAny(std::string_view input) {
+  std::optional<std::size_t> result;
+
+  [&]<std::size_t... is>(std::index_sequence<is...>) {
+    (((input.size() == Pattern<literals, ignore_case>::size &&
+       Pattern<literals, ignore_case>::matches(input.data()))
+          ? (result = is, true)
+          : false) ||
+     ...);
+  }(std::make_index_sequence<sizeof...(literals)>{});
+
+  return result;
+}
+
+}  // namespace detail
+
+template <FixedString<256> literal>
+constexpr bool matchesExactly(std::string_view input) noexcept {
+  using Pattern = detail::Pattern<literal, false>;
+  return input.size() == Pattern::size && Pattern::matches(input.data());
+}
+
+template <FixedString<256> literal>
+constexpr bool matchesIgnoreCase(std::string_view input) noexcept {
+  using Pattern = detail::Pattern<literal, true>;
+  return input.size() == Pattern::size && Pattern::matches(input.data());
+}
+
+template <FixedString<256> literal>
+constexpr bool hasPrefix(std::string_view input) noexcept {
+  using Pattern = detail::Pattern<literal, false>;
+  return input.size() >= Pattern::size && Pattern::matches(input.data());
+}
+
+template <FixedString<256> literal>
+constexpr bool hasPrefixIgnoreCase(std::string_view input) noexcept {
+  using Pattern = detail::Pattern<literal, true>;
+  return input.size() >= Pattern::size && Pattern::matches(input.data());
+}
+
+// Returns the index of the first literal equal to `input`. Candidates are
+// filtered by their compile-time length before any bytes are compared, so
+// usually at most one of them loads `input` at all.
+template <FixedString<256>... literals>
+constexpr std::optional<std::size_t> matchAny(std::string_view input) noexcept {
+  return detail::matchAny<false, literals...>(input);
+}
+
+template <FixedString<256>... literals>
+constexpr std::optional<std::size_t> matchAnyIgnoreCase(
+    std::string_view input) noexcept {
+  return detail::matchAny<true, literals...>(input);
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+template <class From, auto target>
+struct Mapping {
+  using Type = From;
+  static constexpr auto Target = target;
+};
@@ -1,51 +1,340 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <concepts>
+#include <cstdint>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <ranges>
+#include <tuple>
+#include <typeinfo>
+#include <utility>
+#include <vector>
 
-template <class From, auto target>
-struct Mapping {
-  using Type = From;
-  static constexpr auto Target = target;
+#include <Mapping.hpp>
+
+namespace detail {
+
+template <class Range, class Base>
+concept RangeOfPointersTo =
+    std::ranges::input_range<Range> &&
+    requires(std::ranges::range_reference_t<Range> element) {
+      { *element } -> std::convertible_to<const Base&>;
+    };
+
+template <std::size_t n>
+struct MappingOrder {
+  std::array<std::size_t, n> indices{};
+  std::size_t size = 0;
 };
 
+// Topological order of mapped types, most derived first. A type derives from
+// strictly more of the other mapped types than any of its bases, so a stable
+// sort by that count is enough. Mappings shadowed by a later mapping of the
+// same type can never be selected and are dropped.
+template <class... Types>
+constexpr auto derivationOrder() {
+  using Tuple = std::tuple<Types...>;
+  constexpr std::size_t n = sizeof...(Types);
+
+  constexpr auto derives = []<std::size_t... is>(std::index_sequence<is...>) {
+    return std::array<bool, n * n>{
+        std::derived_from<std::tuple_element_t<is / n, Tuple>,
+                          std::tuple_element_t<is % n, Tuple>>...};
+  }(std::make_index_sequence<n * n>{});
+
+  MappingOrder<n> order;
+  std::array<std::size_t, n> bases{};
+
+  for (std::size_t i = 0; i < n; ++i) {
+    bool shadowed = false;
+
+    for (std::size_t j = 0; j < n; ++j) {
+      bases[i] += derives[i * n + j];
+      shadowed |= j > i && derives[i * n + j] && derives[j * n + i];
+    }
+
+    if (!shadowed) {
+      order.indices[order.size++] = i;
+    }
+  }
+
+  // Insertion sort: std::stable_sort is not constexpr.
+  for (std::size_t i = 1; i < order.size; ++i) {
+    for (std::size_t j = i;
+         j > 0 && bases[order.indices[j - 1]] < bases[order.indices[j]]; --j) {
+      std::swap(order.indices[j - 1], order.indices[j]);
+    }
+  }
+
+  return order;
+}
+
+}  // namespace detail
+
 template <class Base, class Target, class... Mappings>
   requires((std::derived_from<typename Mappings::Type, Base> &&
             std::same_as<decltype(Mappings::Target), const Target>) &&
            ...)
 class PolymorphicMapper {
-  template <class C, class Map, class... Maps>
-  static std::optional<Target> getTarget(const Base& object) {
-    if (dynamic_cast<const typename Map::Type*>(&object) != nullptr) {
-      if constexpr (std::derived_from<typename Map::Type, typename C::Type>) {
-        auto target = getTarget<Map, Maps...>(object);
-        if (target) {
-          return target;
+  static constexpr auto kOrder =
+      detail::derivationOrder<typename Mappings::Type...>();
+
+  // Mappings are tried most derived first, so the first successful cast is
+  // the answer and every mapping is cast at most once.
+  template <std::size_t... is>
+  static std::optional<Target> getTarget(const Base& object,
+                                         std::index_sequence<is...>) {
+    using All = std::tuple<Mappings...>;
+    std::optional<Target> target;
+
+    static_cast<void>(
+        ((dynamic_cast<const typename std::tuple_element_t<kOrder.indices[is],
+                                                           All>::Type*>(
+              &object) != nullptr
+              ? (target =
+                     std::tuple_element_t<kOrder.indices[is], All>::Target,
+                 true)
+              : false) ||
+         ...));
+
+    return target;
+  }
+
+  struct TypeClass {
+    const std::type_info* type;
+    std::optional<Target> target;
+  };
+
+  // Calls `f(object, class_index, target)` for every object, running the
+  // dynamic_cast chain once per distinct dynamic type of the batch. Runs of
+  // equal types, the common case, are recognized by one pointer compare.
+  template <class Range, class F>
+  static void classifyAll(Range&& objects, std::vector<TypeClass>& classes,
+                          F&& f) {
+    std::size_t last = 0;
+
+    for (auto&& element : objects) {
+      const Base& object = *element;
+      const std::type_info* type = &typeid(object);
+
+      if (last >= classes.size() || classes[last].type != type) {
+        last = 0;
+        while (last < classes.size() && classes[last].type != type) {
+          ++last;
         }
-      } else {
-        auto target = getTarget<C, Maps...>(object);
-        if (target) {
-          return target;
+
+        if (last == classes.size()) {
+          classes.push_back({type, map(object)});
         }
       }
-      
-      return C::Target;
-    } else {
-      return getTarget<C, Maps...>(object);
+
+      f(object, last, classes[last].target);
     }
   }
 
-  template <class C>
-  static std::optional<Target> getTarget(const Base& object) {
-    if (dynamic_cast<const typename C::Type*>(&object) != nullptr) {
-      return C::Target;
-    } else {
-      return std::nullopt;
+ public:
+  struct Group {
+    std::optional<Target> target;
+    std::vector<const Base*> objects;
+  };
+
+  static std::optional<Target> map(const Base& object) {
+    return getTarget(object, std::make_index_sequence<kOrder.size>{});
+  }
+
+  // Maps a range of pointers to Base; `out[i]` receives the target of the
+  // i-th object, so `out` may be a Slice, std::span or sized container.
+  template <detail::RangeOfPointersTo<Base> Range, class Out>
+    requires requires(Out out, std::size_t i, std::optional<Target> target) {
+      out[i] = target;
     }
+  static void mapAll(Range&& objects, Out&& out) {
+    std::vector<TypeClass> classes;
+    std::size_t i = 0;
+
+    classifyAll(std::forward<Range>(objects), classes,
+                [&out, &i](const Base&, std::size_t,
+                           const std::optional<Target>& target) {
+                  out[i++] = target;
+                });
+  }
+
+  // Same as mapAll, additionally fills `groups` with the objects grouped by
+  // target, so callers can process every group in a separate loop. Groups
+  // left from a previous call keep their position and buffers, new targets
+  // are appended in order of first appearance; empty groups are dropped.
+  template <detail::RangeOfPointersTo<Base> Range, class Out>
+    requires std::equality_comparable<Target> &&
+             requires(Out out, std::size_t i, std::optional<Target> target) {
+               out[i] = target;
+             }
+  static void mapAll(Range&& objects, Out&& out, std::vector<Group>& groups) {
+    std::vector<TypeClass> classes;
+    std::vector<std::size_t> class_groups;
+    std::size_t i = 0;
+
+    for (auto& group : groups) {
+      group.objects.clear();
+    }
+
+    classifyAll(
+        std::forward<Range>(objects), classes,
+        [&](const Base& object, std::size_t class_index,
+            const std::optional<Target>& target) {
+          out[i++] = target;
+
+          if (class_index == class_groups.size()) {
+            auto group = std::find_if(
+                groups.begin(), groups.end(),
+                [&target](const Group& g) { return g.target == target; });
+            class_groups.push_back(group - groups.begin());
+
+            if (group == groups.end()) {
+              groups.push_back({target, {}});
+            }
+          }
+
+          groups[class_groups[class_index]].objects.push_back(&object);
+        });
+
+    std::erase_if(groups, [](const Group& g) { return g.objects.empty(); });
+  }
+};
+
+namespace detail {
+
+static constexpr std::size_t kMapperCacheInitialCapacity = 16;
+
+}  // namespace detail
+
+// Same mapping as PolymorphicMapper, memoized per dynamic type. The cache is
+// an open-addressing table keyed by the address of the object's type_info:
+// readers never lock, a miss runs the dynamic_cast chain once and publishes
+// the result under a mutex. The table is kept at most half full by doubling
+// it, so a lookup stops at an empty slot after a few probes and every type
+// takes the mutex only once. Outgrown tables stay allocated, since readers
+// may still be probing them.
+template <class Base, class Target, class... Mappings>
+class CachedPolymorphicMapper {
+  using Mapper = PolymorphicMapper<Base, Target, Mappings...>;
+
+  struct Slot {
+    std::atomic<const std::type_info*> type = nullptr;
+    std::optional<Target> target;
+  };
+
+  struct Table {
+    explicit Table(std::size_t capacity)
+        : slots(std::make_unique<Slot[]>(capacity)), mask(capacity - 1) {
+    }
+
+    std::unique_ptr<Slot[]> slots;
+    std::size_t mask;
+    std::size_t size = 0;
+  };
+
+  static std::size_t slotIndex(const std::type_info* type, std::size_t mask) {
+    auto hash = static_cast<std::uint64_t>(
+                    reinterpret_cast<std::uintptr_t>(type)) *
+                0x9e3779b97f4a7c15;
+    return static_cast<std::size_t>(hash >> 32) & mask;
+  }
+
+  static Slot* find(Table& table, const std::type_info* type) {
+    for (auto idx = slotIndex(type, table.mask);;
+         idx = (idx + 1) & table.mask) {
+      auto slot_type = table.slots[idx].type.load(std::memory_order_acquire);
+
+      if (slot_type == type || slot_type == nullptr) {
+        return &table.slots[idx];
+      }
+    }
+  }
+
+  // The cached target of `type`, or nullptr. The target is read only after
+  // the acquire load that saw `type` in its slot.
+  static const std::optional<Target>* lookup(Table& table,
+                                             const std::type_info* type) {
+    for (auto idx = slotIndex(type, table.mask);;
+         idx = (idx + 1) & table.mask) {
+      auto slot_type = table.slots[idx].type.load(std::memory_order_acquire);
+
+      if (slot_type == type) {
+        return &table.slots[idx].target;
+      } else if (slot_type == nullptr) {
+        return nullptr;
+      }
+    }
+  }
+
+  static void insert(Table& table, const std::type_info* type,
+                     const std::optional<Target>& target) {
+    auto* slot = find(table, type);
+    slot->target = target;
+    slot->type.store(type, std::memory_order_release);
+    ++table.size;
+  }
+
+  // Called with the mutex held. Publishes the new table only once it is
+  // filled, so readers never see it half copied.
+  static Table& grow(Table* old) {
+    auto capacity = old == nullptr ? detail::kMapperCacheInitialCapacity
+                                   : 2 * (old->mask + 1);
+    auto& table = *tables_.emplace_back(std::make_unique<Table>(capacity));
+
+    if (old != nullptr) {
+      for (std::size_t i = 0; i <= old->mask; ++i) {
+        auto* type = old->slots[i].type.load(std::memory_order_relaxed);
+        if (type != nullptr) {
+          insert(table, type, old->slots[i].target);
+        }
+      }
+    }
+
+    table_.store(&table, std::memory_order_release);
+    return table;
+  }
+
+  static void remember(const std::type_info* type,
+                       const std::optional<Target>& target) {
+    std::lock_guard guard(mutex_);
+
+    auto* table = table_.load(std::memory_order_relaxed);
+    if (table != nullptr && lookup(*table, type) != nullptr) {
+      return;
+    }
+
+    if (table == nullptr || 2 * (table->size + 1) > table->mask + 1) {
+      table = &grow(table);
+    }
+    insert(*table, type, target);
   }
 
  public:
   static std::optional<Target> map(const Base& object) {
-    return getTarget<Mapping<Base, std::nullopt>, Mappings...>(object);
+    const std::type_info* type = &typeid(object);
+
+    if (auto* table = table_.load(std::memory_order_acquire)) {
+      if (const auto* target = lookup(*table, type)) {
+        return *target;
+      }
+    }
+
+    auto target = Mapper::map(object);
+    remember(type, target);
+    return target;
   }
+
+ private:
+  static_assert(std::has_single_bit(detail::kMapperCacheInitialCapacity));
+
+  static inline std::atomic<Table*> table_ = nullptr;
+  static inline std::vector<std::unique_ptr<Table>> tables_;
+  static inline std::mutex mutex_;
 };
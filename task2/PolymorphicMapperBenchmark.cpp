@@ -0,0 +1,219 @@
+// Compares PolymorphicMapper::map with a virtual method and with a switch on
+// a stored kind, for hierarchies of 2 to 64 mapped classes that are either
+// wide (siblings of Base) or deep (a single inheritance chain). "tput" rows
+// time independent calls, "latency" rows calls whose argument depends on
+// the previous result.
+//
+// Build with optimizations, e.g.
+//   g++ -std=c++20 -O2 -I. PolymorphicMapperBenchmark.cpp
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <optional>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <PolymorphicMapper.hpp>
+
+namespace {
+
+static constexpr std::size_t kIterations = 1 << 20;
+
+template <class T>
+void doNotOptimize(const T& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct Base {
+  virtual ~Base() = default;
+
+  virtual std::optional<int> target() const {
+    return std::nullopt;
+  }
+
+  int kind = -1;
+};
+
+struct Unmapped : Base {};
+
+template <std::size_t i>
+struct Wide : Base {
+  Wide() {
+    kind = i;
+  }
+
+  std::optional<int> target() const override {
+    return i;
+  }
+};
+
+template <std::size_t depth>
+struct Deep : Deep<depth - 1> {
+  Deep() {
+    this->kind = depth;
+  }
+
+  std::optional<int> target() const override {
+    return depth;
+  }
+};
+
+template <>
+struct Deep<0> : Base {
+  Deep() {
+    kind = 0;
+  }
+
+  std::optional<int> target() const override {
+    return 0;
+  }
+};
+
+template <template <std::size_t> class Node, std::size_t... is>
+auto makeMapper(std::index_sequence<is...>)
+    -> PolymorphicMapper<Base, int, Mapping<Node<is>, static_cast<int>(is)>...>;
+
+template <template <std::size_t> class Node, std::size_t... is>
+auto makeCachedMapper(std::index_sequence<is...>)
+    -> CachedPolymorphicMapper<Base, int,
+                               Mapping<Node<is>, static_cast<int>(is)>...>;
+
+#define TARGET_CASE(i)     \
+  case i:                  \
+    if constexpr (i < n) { \
+      return i;            \
+    }                      \
+    break;
+
+template <std::size_t n>
+std::optional<int> switchTarget(const Base& object) {
+  static_assert(n <= 64);
+
+  switch (object.kind) {
+    TARGET_CASE(0) TARGET_CASE(1) TARGET_CASE(2) TARGET_CASE(3) TARGET_CASE(4)
+    TARGET_CASE(5) TARGET_CASE(6) TARGET_CASE(7) TARGET_CASE(8) TARGET_CASE(9)
+    TARGET_CASE(10) TARGET_CASE(11) TARGET_CASE(12) TARGET_CASE(13)
+    TARGET_CASE(14) TARGET_CASE(15) TARGET_CASE(16) TARGET_CASE(17)
+    TARGET_CASE(18) TARGET_CASE(19) TARGET_CASE(20) TARGET_CASE(21)
+    TARGET_CASE(22) TARGET_CASE(23) TARGET_CASE(24) TARGET_CASE(25)
+    TARGET_CASE(26) TARGET_CASE(27) TARGET_CASE(28) TARGET_CASE(29)
+    TARGET_CASE(30) TARGET_CASE(31) TARGET_CASE(32) TARGET_CASE(33)
+    TARGET_CASE(34) TARGET_CASE(35) TARGET_CASE(36) TARGET_CASE(37)
+    TARGET_CASE(38) TARGET_CASE(39) TARGET_CASE(40) TARGET_CASE(41)
+    TARGET_CASE(42) TARGET_CASE(43) TARGET_CASE(44) TARGET_CASE(45)
+    TARGET_CASE(46) TARGET_CASE(47) TARGET_CASE(48) TARGET_CASE(49)
+    TARGET_CASE(50) TARGET_CASE(51) TARGET_CASE(52) TARGET_CASE(53)
+    TARGET_CASE(54) TARGET_CASE(55) TARGET_CASE(56) TARGET_CASE(57)
+    TARGET_CASE(58) TARGET_CASE(59) TARGET_CASE(60) TARGET_CASE(61)
+    TARGET_CASE(62) TARGET_CASE(63)
+  }
+  return std::nullopt;
+}
+
+#undef TARGET_CASE
+
+template <template <std::size_t> class Node, std::size_t... is>
+std::vector<std::unique_ptr<Base>> makeObjects(std::index_sequence<is...>) {
+  std::vector<std::unique_ptr<Base>> objects;
+  (objects.push_back(std::make_unique<Node<is>>()), ...);
+  return objects;
+}
+
+template <class F>
+double nsPerCall(const std::vector<const Base*>& objects, F&& f) {
+  auto start = std::chrono::steady_clock::now();
+
+  for (std::size_t i = 0; i < kIterations; ++i) {
+    doNotOptimize(f(*objects[i & (objects.size() - 1)]));
+  }
+
+  std::chrono::duration<double, std::nano> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count() / kIterations;
+}
+
+// Each call starts only once the previous one has returned, since its
+// argument depends on the previous result.
+template <class F>
+double nsPerDependentCall(const std::vector<const Base*>& objects, F&& f) {
+  auto start = std::chrono::steady_clock::now();
+
+  std::size_t next = 0;
+  for (std::size_t i = 0; i < kIterations; ++i) {
+    auto target = f(*objects[next]);
+    next = (next + 1 + static_cast<std::size_t>(target.value_or(0))) &
+           (objects.size() - 1);
+  }
+  doNotOptimize(next);
+
+  std::chrono::duration<double, std::nano> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count() / kIterations;
+}
+
+template <class Mapper, class CachedMapper, std::size_t n, class Measure>
+void printRow(const char* shape, const char* name, const char* mode,
+              const std::vector<const Base*>& objects, Measure measure) {
+  std::printf(
+      "%-5s %3zu  %-12s %-7s %9.2f %9.2f %9.2f %9.2f\n", shape, n, name, mode,
+      measure(objects, [](const Base& o) { return Mapper::map(o); }),
+      measure(objects, [](const Base& o) { return CachedMapper::map(o); }),
+      measure(objects, [](const Base& o) { return o.target(); }),
+      measure(objects, [](const Base& o) { return switchTarget<n>(o); }));
+}
+
+template <class Mapper, class CachedMapper, std::size_t n>
+void runCase(const char* shape, const char* name,
+             const std::vector<const Base*>& objects) {
+  printRow<Mapper, CachedMapper, n>(
+      shape, name, "tput", objects,
+      [](const auto& objects, auto f) { return nsPerCall(objects, f); });
+  printRow<Mapper, CachedMapper, n>(
+      shape, name, "latency", objects, [](const auto& objects, auto f) {
+        return nsPerDependentCall(objects, f);
+      });
+}
+
+// `objects` sizes are powers of two so that indexing is a mask.
+template <template <std::size_t> class Node, std::size_t n>
+void runShape(const char* shape) {
+  using Mapper = decltype(makeMapper<Node>(std::make_index_sequence<n>{}));
+  using CachedMapper =
+      decltype(makeCachedMapper<Node>(std::make_index_sequence<n>{}));
+
+  auto owned = makeObjects<Node>(std::make_index_sequence<n>{});
+  Unmapped unmapped;
+
+  std::vector<const Base*> hit(1, owned.front().get());
+  std::vector<const Base*> most_derived(1, owned.back().get());
+  std::vector<const Base*> miss(1, &unmapped);
+
+  std::vector<const Base*> mixed(1024);
+  std::mt19937 rng(n);
+  for (auto& object : mixed) {
+    object = owned[rng() % n].get();
+  }
+
+  runCase<Mapper, CachedMapper, n>(shape, "hit", hit);
+  runCase<Mapper, CachedMapper, n>(shape, "most-derived", most_derived);
+  runCase<Mapper, CachedMapper, n>(shape, "miss", miss);
+  runCase<Mapper, CachedMapper, n>(shape, "mixed", mixed);
+}
+
+template <std::size_t... ns>
+void runAll() {
+  (runShape<Wide, ns>("wide"), ...);
+  (runShape<Deep, ns>("deep"), ...);
+}
+
+}  // namespace
+
+int main() {
+  std::printf("%-5s %3s  %-12s %-7s %9s %9s %9s %9s   (ns per call)\n",
+              "shape", "n", "case", "mode", "mapper", "cached", "virtual",
+              "switch");
+  runAll<2, 4, 8, 16, 32, 64>();
+}
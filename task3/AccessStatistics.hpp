@@ -0,0 +1,188 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <utility>
+
+// Distribution of accesses per expression, recorded by Spy loggers from any
+// number of threads. Values go into a fixed log-scale histogram: exact below
+// 4, then four buckets per power of two, so a percentile is off by at most
+// a quarter of its value.
+class AccessStatistics {
+  static constexpr std::size_t kSubBuckets = 4;
+  static constexpr std::size_t kSubBits = 2;
+
+ public:
+  static constexpr std::size_t kBuckets =
+      kSubBuckets + (std::numeric_limits<unsigned>::digits - kSubBits) *
+                        kSubBuckets;
+
+  static constexpr std::size_t bucketOf(unsigned value) noexcept {
+    if (value < kSubBuckets) {
+      return value;
+    }
+    std::size_t exp = std::bit_width(value) - 1;
+    std::size_t sub = (value >> (exp - kSubBits)) & (kSubBuckets - 1);
+    return kSubBuckets + (exp - kSubBits) * kSubBuckets + sub;
+  }
+
+  static constexpr unsigned bucketLower(std::size_t bucket) noexcept {
+    if (bucket < kSubBuckets) {
+      return bucket;
+    }
+    std::size_t exp = (bucket - kSubBuckets) / kSubBuckets + kSubBits;
+    std::size_t sub = (bucket - kSubBuckets) % kSubBuckets;
+    return (kSubBuckets + sub) << (exp - kSubBits);
+  }
+
+  static constexpr unsigned bucketUpper(std::size_t bucket) noexcept {
+    return bucket + 1 < kBuckets ? bucketLower(bucket + 1) - 1
+                                 : std::numeric_limits<unsigned>::max();
+  }
+
+  // Counters are read one at a time, so a snapshot taken while threads
+  // record may count a value in `sum` but not yet in `buckets`. `min` and
+  // `max` always cover every value counted in `buckets`.
+  struct Snapshot {
+    std::array<std::uint64_t, kBuckets> buckets{};
+    std::uint64_t count = 0;
+    std::uint64_t sum = 0;
+    unsigned min = 0;
+    unsigned max = 0;
+
+    double mean() const {
+      return count == 0 ? 0.0 : static_cast<double>(sum) / count;
+    }
+
+    // Upper bound of the bucket holding the `p`-th percentile, p in [0, 100],
+    // clamped to the observed range.
+    unsigned percentile(double p) const {
+      if (count == 0) {
+        return 0;
+      }
+
+      auto rank = static_cast<std::uint64_t>(
+          std::ceil(std::clamp(p, 0.0, 100.0) / 100 * count));
+      rank = std::max<std::uint64_t>(rank, 1);
+
+      std::uint64_t seen = 0;
+      for (std::size_t i = 0; i < kBuckets; ++i) {
+        seen += buckets[i];
+        if (seen >= rank) {
+          return std::clamp(bucketUpper(i), min, max);
+        }
+      }
+      return max;
+    }
+
+    std::string toJson() const {
+      std::string json = "{\"count\":";
+      appendNumber(json, count);
+      json += ",\"min\":";
+      appendNumber(json, min);
+      json += ",\"max\":";
+      appendNumber(json, max);
+      json += ",\"mean\":";
+      appendNumber(json, mean());
+
+      for (auto [name, p] : {std::pair{"p50", 50.0}, std::pair{"p90", 90.0},
+                             std::pair{"p99", 99.0}, std::pair{"p999", 99.9}}) {
+        json += ",\"" + std::string(name) + "\":";
+        appendNumber(json, percentile(p));
+      }
+
+      json += ",\"buckets\":[";
+      bool first = true;
+      for (std::size_t i = 0; i < kBuckets; ++i) {
+        if (buckets[i] == 0) {
+          continue;
+        }
+        json += first ? "{\"lower\":" : ",{\"lower\":";
+        appendNumber(json, bucketLower(i));
+        json += ",\"upper\":";
+        appendNumber(json, bucketUpper(i));
+        json += ",\"count\":";
+        appendNumber(json, buckets[i]);
+        json += "}";
+        first = false;
+      }
+      return json + "]}";
+    }
+
+   private:
+    // std::to_chars, unlike std::to_string, ignores the locale, which could
+    // otherwise write a decimal comma.
+    template <class Number>
+    static void appendNumber(std::string& json, Number value) {
+      char buffer[32];
+      auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+      json.append(buffer, end);
+    }
+  };
+
+  // Trivially copyable handle to pass to Spy::setLogger.
+  class Logger {
+   public:
+    explicit Logger(AccessStatistics& statistics) : statistics_(&statistics) {
+    }
+
+    void operator()(unsigned value) const {
+      statistics_->record(value);
+    }
+
+   private:
+    AccessStatistics* statistics_;
+  };
+
+ public:
+  Logger logger() noexcept {
+    return Logger(*this);
+  }
+
+  void record(unsigned value) noexcept {
+    auto min = min_.load(std::memory_order_relaxed);
+    while (value < min &&
+           !min_.compare_exchange_weak(min, value, std::memory_order_relaxed)) {
+    }
+
+    auto max = max_.load(std::memory_order_relaxed);
+    while (value > max &&
+           !max_.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+    }
+
+    sum_.fetch_add(value, std::memory_order_relaxed);
+    buckets_[bucketOf(value)].fetch_add(1, std::memory_order_release);
+  }
+
+  // Reads every counter once without stopping recording threads.
+  Snapshot snapshot() const noexcept {
+    Snapshot result;
+
+    for (std::size_t i = 0; i < kBuckets; ++i) {
+      result.buckets[i] = buckets_[i].load(std::memory_order_acquire);
+      result.count += result.buckets[i];
+    }
+
+    if (result.count != 0) {
+      result.sum = sum_.load(std::memory_order_relaxed);
+      result.min = min_.load(std::memory_order_relaxed);
+      result.max = max_.load(std::memory_order_relaxed);
+    }
+
+    return result;
+  }
+
+ private:
+  std::array<std::atomic<std::uint64_t>, kBuckets> buckets_{};
+  std::atomic<std::uint64_t> sum_ = 0;
+  std::atomic<unsigned> min_ = std::numeric_limits<unsigned>::max();
+  std::atomic<unsigned> max_ = 0;
+};
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <utility>
+
+enum class BackPressure {
+  Drop,   // a full queue loses the access count
+  Block,  // the observed expression waits for a free slot
+};
+
+namespace detail {
+
+// Bounded lock-free multi-producer single-consumer queue: every cell carries
+// a sequence number telling whether it is free for the producer at `pos` or
+// filled for the consumer at `pos`.
+class AccessQueue {
+  struct Cell {
+    std::atomic<std::size_t> sequence;
+    unsigned value;
+  };
+
+ public:
+  explicit AccessQueue(std::size_t capacity)
+      : mask_(std::bit_ceil(capacity) - 1),
+        cells_(std::make_unique<Cell[]>(mask_ + 1)) {
+    for (std::size_t i = 0; i <= mask_; ++i) {
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  bool tryPush(unsigned value) {
+    auto pos = enqueue_pos_.load(std::memory_order_relaxed);
+
+    while (true) {
+      Cell& cell = cells_[pos & mask_];
+      auto sequence = cell.sequence.load(std::memory_order_acquire);
+      auto diff = static_cast<std::ptrdiff_t>(sequence - pos);
+
+      if (diff == 0) {
+        if (enqueue_pos_.compare_exchange_weak(pos, pos + 1,
+                                               std::memory_order_relaxed)) {
+          cell.value = value;
+          cell.sequence.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = enqueue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // Only called from the consumer thread.
+  bool tryPop(unsigned& value) {
+    Cell& cell = cells_[dequeue_pos_ & mask_];
+
+    if (cell.sequence.load(std::memory_order_acquire) != dequeue_pos_ + 1) {
+      return false;
+    }
+
+    value = cell.value;
+    cell.sequence.store(dequeue_pos_ + mask_ + 1, std::memory_order_release);
+    ++dequeue_pos_;
+    return true;
+  }
+
+  std::size_t pushed() const {
+    return enqueue_pos_.load(std::memory_order_acquire);
+  }
+
+ private:
+  const std::size_t mask_;
+  std::unique_ptr<Cell[]> cells_;
+
+  alignas(64) std::atomic<std::size_t> enqueue_pos_ = 0;
+  alignas(64) std::size_t dequeue_pos_ = 0;
+};
+
+}  // namespace detail
+
+// Logger adaptor for Spy that moves the user logger off the observed
+// expression: calling it only pushes the access count into a bounded queue,
+// and `Logger` runs on a background thread owned by the adaptor. Copies
+// share the queue and the thread; the last copy to go away waits until every
+// queued count has been logged.
+template <std::invocable<unsigned> Logger>
+class AsyncLogger {
+  static constexpr auto kMaxIdle = std::chrono::milliseconds(1);
+
+  struct State {
+    State(Logger&& logger, std::size_t capacity, BackPressure policy)
+        : queue(capacity), policy(policy), logger(std::move(logger)) {
+      consumer = std::thread([this] { consume(); });
+    }
+
+    ~State() {
+      stop.store(true, std::memory_order_release);
+      consumer.join();
+    }
+
+    void consume() {
+      auto idle = std::chrono::microseconds(1);
+
+      while (true) {
+        bool stopping = stop.load(std::memory_order_acquire);
+        unsigned value;
+
+        if (queue.tryPop(value)) {
+          logger(value);
+          logged.fetch_add(1, std::memory_order_release);
+          idle = std::chrono::microseconds(1);
+        } else if (stopping && logged.load(std::memory_order_relaxed) ==
+                                   queue.pushed()) {
+          return;
+        } else {
+          std::this_thread::sleep_for(idle);
+          idle = std::min<std::chrono::microseconds>(idle * 2, kMaxIdle);
+        }
+      }
+    }
+
+    detail::AccessQueue queue;
+    BackPressure policy;
+    Logger logger;
+    std::atomic<std::size_t> logged = 0;
+    std::atomic<std::size_t> dropped = 0;
+    std::atomic<bool> stop = false;
+    std::thread consumer;
+  };
+
+ public:
+  explicit AsyncLogger(Logger logger, std::size_t capacity = 1024,
+                       BackPressure policy = BackPressure::Drop)
+      : state_(std::make_shared<State>(std::move(logger), capacity, policy)) {
+  }
+
+  void operator()(unsigned count) const {
+    while (!state_->queue.tryPush(count)) {
+      if (state_->policy == BackPressure::Drop) {
+        state_->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+
+      std::this_thread::yield();
+    }
+  }
+
+  // Waits until every count pushed before the call has been logged.
+  void flush() const {
+    auto pushed = state_->queue.pushed();
+
+    while (state_->logged.load(std::memory_order_acquire) < pushed) {
+      std::this_thread::yield();
+    }
+  }
+
+  std::size_t dropped() const {
+    return state_->dropped.load(std::memory_order_relaxed);
+  }
+
+ private:
+  std::shared_ptr<State> state_;
+};
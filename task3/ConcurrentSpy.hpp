@@ -0,0 +1,194 @@
+#pragma once
+
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+#include <Spy.hpp>
+
+namespace detail {
+
+// Access count of one expression over one spy on the current thread. Frames
+// live inside the first wrapper of the expression and are chained into a
+// thread-local list, so the access path neither locks nor allocates.
+struct AccessFrame {
+  const void* spy;
+  unsigned ref_cnt;
+  AccessFrame* next;
+};
+
+inline thread_local AccessFrame* tls_access_frames = nullptr;
+
+template <class T, class Spy>
+class SharedLifetimeWrapper {
+ public:
+  SharedLifetimeWrapper(T* value_ptr, Spy* spy)
+      : value_ptr_(value_ptr), spy_(spy) {
+    for (auto* frame = tls_access_frames; frame != nullptr;
+         frame = frame->next) {
+      if (frame->spy == spy) {
+        frame_ = frame;
+        return;
+      }
+    }
+
+    own_ = {spy, 0, tls_access_frames};
+    tls_access_frames = &own_;
+  }
+
+  SharedLifetimeWrapper(const SharedLifetimeWrapper&) = delete;
+  SharedLifetimeWrapper& operator=(const SharedLifetimeWrapper&) = delete;
+
+  // The first wrapper of an expression is destroyed last and logs it.
+  ~SharedLifetimeWrapper() {
+    if (frame_ != &own_) {
+      return;
+    }
+
+    auto** link = &tls_access_frames;
+    while (*link != &own_) {
+      link = &(*link)->next;
+    }
+    *link = own_.next;
+
+    spy_->publish(own_.ref_cnt);
+  }
+
+  T* operator->() {
+    ++frame_->ref_cnt;
+    return value_ptr_;
+  }
+
+ private:
+  T* value_ptr_;
+  Spy* spy_;
+  AccessFrame own_;
+  AccessFrame* frame_ = &own_;
+};
+
+}  // namespace detail
+
+// Spy that may be shared between threads. Every thread tracks its own
+// expressions in thread-local frames; when an expression ends its access
+// count goes to the logger and into totals kept in relaxed atomics.
+//
+// The logger is called from whichever thread finished the expression, so it
+// must be safe to call concurrently. setLogger, copies and assignments are
+// not synchronized with accesses.
+template <class T, class Allocator = std::allocator<std::byte>,
+          std::size_t BufferSize = detail::kSmallBufferSize,
+          std::size_t Alignment = alignof(std::max_align_t)>
+class ConcurrentSpy {
+  using Wrapper = detail::LoggerWrapper<T, Allocator, BufferSize, Alignment>;
+
+  template <class U, class S>
+  friend class detail::SharedLifetimeWrapper;
+
+ public:
+  explicit ConcurrentSpy(T value, const Allocator& alloc = Allocator())
+      : value_(std::move(value)), wrapper_(alloc) {
+  }
+
+  explicit ConcurrentSpy(const Allocator& alloc = Allocator())
+    requires std::default_initializable<T>
+      : value_(T()), wrapper_(alloc) {
+  }
+
+  ConcurrentSpy(const ConcurrentSpy& other)
+    requires std::copyable<T>
+      : value_(other.value_), wrapper_(other.wrapper_) {
+  }
+
+  ConcurrentSpy(ConcurrentSpy&& other)
+    requires std::movable<T>
+      : value_(std::move(other.value_)), wrapper_(std::move(other.wrapper_)) {
+  }
+
+  ConcurrentSpy& operator=(const ConcurrentSpy& other)
+    requires std::copyable<T>
+  {
+    if (this == &other) {
+      return *this;
+    }
+
+    value_ = other.value_;
+    wrapper_ = other.wrapper_;
+
+    return *this;
+  }
+
+  ConcurrentSpy& operator=(ConcurrentSpy&& other)
+    requires std::movable<T>
+  {
+    if (this == &other) {
+      return *this;
+    }
+
+    value_ = std::move(other.value_);
+    wrapper_ = std::move(other.wrapper_);
+
+    return *this;
+  }
+
+  ~ConcurrentSpy() {
+    setLogger();
+  }
+
+  T& operator*() {
+    return value_;
+  }
+
+  const T& operator*() const {
+    return value_;
+  }
+
+  detail::SharedLifetimeWrapper<T, ConcurrentSpy> operator->() {
+    return {&value_, this};
+  }
+
+  template <std::equality_comparable_with<T> U, class AllocatorOther>
+  bool operator==(const ConcurrentSpy<U, AllocatorOther, BufferSize,
+                                      Alignment>& other) const {
+    return value_ == other.value_;
+  }
+
+  // Number of finished expressions and of accesses in them, over all threads.
+  std::size_t expressions() const {
+    return expressions_.load(std::memory_order_relaxed);
+  }
+
+  std::size_t accesses() const {
+    return accesses_.load(std::memory_order_relaxed);
+  }
+
+  // Resets logger
+  void setLogger() {
+    wrapper_.reset();
+  }
+
+  template <std::invocable<unsigned> Logger>
+  void setLogger(Logger&& logger)
+    requires(std::move_constructible<Logger> && std::move_constructible<T> &&
+             !std::copy_constructible<T>) ||
+            (std::copy_constructible<Logger> && std::copy_constructible<T>)
+  {
+    wrapper_.emplace(std::forward<Logger>(logger));
+  }
+
+ private:
+  void publish(unsigned ref_cnt) {
+    expressions_.fetch_add(1, std::memory_order_relaxed);
+    accesses_.fetch_add(ref_cnt, std::memory_order_relaxed);
+    if (wrapper_) {
+      wrapper_(ref_cnt);
+    }
+  }
+
+ private:
+  T value_;
+  Wrapper wrapper_;
+  std::atomic<std::size_t> expressions_ = 0;
+  std::atomic<std::size_t> accesses_ = 0;
+};
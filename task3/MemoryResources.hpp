@@ -0,0 +1,249 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+// Memory resources for Spy loggers that do not fit the inline buffer, and an
+// allocator that keeps using the same resource when Spies are copied. None
+// of them is synchronized.
+
+// Bump allocator: deallocation is a no-op and memory comes back only with
+// release() or destruction. Starts in `initial` if given, then takes chunks
+// of growing size from `upstream`; with std::pmr::null_memory_resource() it
+// never touches the heap and throws std::bad_alloc when `initial` runs out.
+class MonotonicArena : public std::pmr::memory_resource {
+  static constexpr std::size_t kMinChunkSize = 1024;
+
+  struct Chunk {
+    Chunk* next;
+    std::size_t size;
+  };
+
+ public:
+  explicit MonotonicArena(
+      std::span<std::byte> initial = {},
+      std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+      : upstream_(upstream),
+        initial_(initial),
+        current_(initial.data()),
+        left_(initial.size()),
+        next_chunk_size_(std::max(kMinChunkSize, initial.size())) {
+  }
+
+  explicit MonotonicArena(std::pmr::memory_resource* upstream)
+      : MonotonicArena({}, upstream) {
+  }
+
+  MonotonicArena(const MonotonicArena&) = delete;
+  MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+  ~MonotonicArena() override {
+    release();
+  }
+
+  // Frees every chunk and starts over from `initial`.
+  void release() {
+    while (chunks_ != nullptr) {
+      auto* chunk = std::exchange(chunks_, chunks_->next);
+      upstream_->deallocate(chunk, chunk->size, alignof(std::max_align_t));
+    }
+
+    current_ = initial_.data();
+    left_ = initial_.size();
+  }
+
+ private:
+  void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+    void* ptr = current_;
+
+    if (std::align(alignment, bytes, ptr, left_) == nullptr) {
+      grow(bytes + alignment);
+      ptr = current_;
+      std::align(alignment, bytes, ptr, left_);
+    }
+
+    current_ = static_cast<std::byte*>(ptr) + bytes;
+    left_ -= bytes;
+    return ptr;
+  }
+
+  void do_deallocate(void*, std::size_t, std::size_t) override {
+  }
+
+  bool do_is_equal(const memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+
+  void grow(std::size_t min_bytes) {
+    auto size = std::max(next_chunk_size_, sizeof(Chunk) + min_bytes);
+    auto* chunk = static_cast<Chunk*>(
+        upstream_->allocate(size, alignof(std::max_align_t)));
+
+    chunks_ = new (chunk) Chunk{chunks_, size};
+    current_ = reinterpret_cast<std::byte*>(chunk + 1);
+    left_ = size - sizeof(Chunk);
+    next_chunk_size_ = size * 2;
+  }
+
+ private:
+  std::pmr::memory_resource* upstream_;
+  std::span<std::byte> initial_;
+  Chunk* chunks_ = nullptr;
+  std::byte* current_;
+  std::size_t left_;
+  std::size_t next_chunk_size_;
+};
+
+// Pool of equal blocks with a free list: blocks of at most `block_size` bytes
+// and max_align_t alignment are reused after deallocation, which suits
+// copying and destroying many Spies with the same logger type. Blocks are
+// carved from slabs of `blocks_per_slab` taken from `upstream`; other
+// requests go to `upstream` directly.
+class FixedPool : public std::pmr::memory_resource {
+  static constexpr std::size_t kAlignment = alignof(std::max_align_t);
+
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+
+  struct Slab {
+    Slab* next;
+  };
+
+  static constexpr std::size_t kSlabHeader =
+      (sizeof(Slab) + kAlignment - 1) / kAlignment * kAlignment;
+
+ public:
+  explicit FixedPool(
+      std::size_t block_size, std::size_t blocks_per_slab = 64,
+      std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+      : upstream_(upstream),
+        block_size_((std::max(block_size, sizeof(FreeBlock)) + kAlignment - 1) /
+                    kAlignment * kAlignment),
+        blocks_per_slab_(std::max<std::size_t>(blocks_per_slab, 1)) {
+  }
+
+  FixedPool(const FixedPool&) = delete;
+  FixedPool& operator=(const FixedPool&) = delete;
+
+  ~FixedPool() override {
+    release();
+  }
+
+  std::size_t blockSize() const noexcept {
+    return block_size_;
+  }
+
+  // Frees every slab, including blocks still in use.
+  void release() {
+    while (slabs_ != nullptr) {
+      auto* slab = std::exchange(slabs_, slabs_->next);
+      upstream_->deallocate(slab, slabSize(), kAlignment);
+    }
+    free_ = nullptr;
+  }
+
+ private:
+  void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+    if (bytes > block_size_ || alignment > kAlignment) {
+      return upstream_->allocate(bytes, alignment);
+    }
+
+    if (free_ == nullptr) {
+      addSlab();
+    }
+
+    return std::exchange(free_, free_->next);
+  }
+
+  void do_deallocate(void* ptr, std::size_t bytes,
+                     std::size_t alignment) override {
+    if (bytes > block_size_ || alignment > kAlignment) {
+      upstream_->deallocate(ptr, bytes, alignment);
+      return;
+    }
+
+    free_ = new (ptr) FreeBlock{free_};
+  }
+
+  bool do_is_equal(const memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+
+  std::size_t slabSize() const noexcept {
+    return kSlabHeader + block_size_ * blocks_per_slab_;
+  }
+
+  void addSlab() {
+    auto* memory =
+        static_cast<std::byte*>(upstream_->allocate(slabSize(), kAlignment));
+    slabs_ = new (memory) Slab{slabs_};
+
+    for (std::size_t i = blocks_per_slab_; i-- > 0;) {
+      free_ = new (memory + kSlabHeader + i * block_size_) FreeBlock{free_};
+    }
+  }
+
+ private:
+  std::pmr::memory_resource* upstream_;
+  std::size_t block_size_;
+  std::size_t blocks_per_slab_;
+  Slab* slabs_ = nullptr;
+  FreeBlock* free_ = nullptr;
+};
+
+// Allocator over a std::pmr::memory_resource that, unlike
+// std::pmr::polymorphic_allocator, follows its container: copies of a Spy
+// allocate from the same resource, and assignment and swap carry the
+// resource along.
+template <class T>
+class ResourceAllocator {
+ public:
+  using value_type = T;
+  using propagate_on_container_copy_assignment = std::true_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+
+  ResourceAllocator() noexcept
+      : resource_(std::pmr::get_default_resource()) {
+  }
+
+  ResourceAllocator(std::pmr::memory_resource* resource) noexcept
+      : resource_(resource) {
+  }
+
+  template <class U>
+  ResourceAllocator(const ResourceAllocator<U>& other) noexcept
+      : resource_(other.resource()) {
+  }
+
+  T* allocate(std::size_t n) {
+    return static_cast<T*>(resource_->allocate(n * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T* ptr, std::size_t n) noexcept {
+    resource_->deallocate(ptr, n * sizeof(T), alignof(T));
+  }
+
+  ResourceAllocator select_on_container_copy_construction() const noexcept {
+    return *this;
+  }
+
+  std::pmr::memory_resource* resource() const noexcept {
+    return resource_;
+  }
+
+  template <class U>
+  bool operator==(const ResourceAllocator<U>& other) const noexcept {
+    return *resource_ == *other.resource();
+  }
+
+ private:
+  std::pmr::memory_resource* resource_;
+};
@@ -0,0 +1,231 @@
+// Checks the memory resources through Spy's Allocator parameter: copying a
+// Spy with a logger larger than the inline buffer many times through a
+// FixedPool, running a MonotonicArena without upstream out of memory, and
+// ResourceAllocator following its Spy on assignment and swap. Global
+// operator new is counted, so any general-purpose heap allocation shows up.
+//
+// Build and run, e.g.
+//   g++ -std=c++20 -I. MemoryResourcesTest.cpp && ./a.out
+
+#include <array>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <memory_resource>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include <MemoryResources.hpp>
+#include <Spy.hpp>
+
+namespace {
+
+std::size_t global_allocations = 0;
+int failures = 0;
+
+void check(bool condition, const char* what) {
+  if (!condition) {
+    std::printf("FAILED: %s\n", what);
+    ++failures;
+  }
+}
+
+// Upstream that counts what goes through it.
+class CountingResource : public std::pmr::memory_resource {
+ public:
+  std::size_t allocations() const noexcept {
+    return allocations_;
+  }
+
+  std::size_t live() const noexcept {
+    return live_;
+  }
+
+ private:
+  void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+    ++allocations_;
+    ++live_;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+  }
+
+  void do_deallocate(void* ptr, std::size_t bytes,
+                     std::size_t alignment) override {
+    --live_;
+    std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+  }
+
+  bool do_is_equal(const memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+
+ private:
+  std::size_t allocations_ = 0;
+  std::size_t live_ = 0;
+};
+
+struct LargeLogger {
+  void operator()(unsigned count) const {
+    *total += count + padding[count & 127];
+  }
+
+  unsigned* total;
+  std::array<unsigned char, 128> padding{};
+};
+
+static_assert(sizeof(LargeLogger) > detail::kSmallBufferSize);
+
+struct Value {
+  int n = 0;
+};
+
+using PoolAllocator = ResourceAllocator<std::byte>;
+using PooledSpy = Spy<Value, PoolAllocator>;
+
+void testPoolCopies() {
+  static constexpr std::size_t kCopies = 1000;
+  static constexpr std::size_t kBlocksPerSlab = 64;
+
+  CountingResource upstream;
+  FixedPool pool(sizeof(LargeLogger), kBlocksPerSlab, &upstream);
+  unsigned total = 0;
+
+  PooledSpy original({1}, PoolAllocator(&pool));
+  original.setLogger(LargeLogger{&total});
+
+  std::vector<PooledSpy> copies;
+  copies.reserve(kCopies);
+
+  auto global_before = global_allocations;
+  for (std::size_t i = 0; i < kCopies; ++i) {
+    copies.push_back(original);
+  }
+  check(global_allocations == global_before,
+        "pooled copies do no general-purpose heap allocations");
+  check(upstream.allocations() == (kCopies + 1 + kBlocksPerSlab - 1) /
+                                      kBlocksPerSlab,
+        "pooled copies take one upstream slab per 64 loggers");
+
+  for (auto& copy : copies) {
+    static_cast<void>(copy->n);
+  }
+  check(total == kCopies, "every copy logs through its own logger");
+
+  auto slabs = upstream.allocations();
+  copies.clear();
+  for (std::size_t i = 0; i < kCopies; ++i) {
+    copies.push_back(original);
+  }
+  check(upstream.allocations() == slabs,
+        "destroyed copies return their blocks to the pool");
+}
+
+void testArenaExhaustion() {
+  alignas(std::max_align_t) std::array<std::byte, 4 * sizeof(LargeLogger)>
+      buffer;
+  MonotonicArena arena(buffer, std::pmr::null_memory_resource());
+  unsigned total = 0;
+
+  std::vector<PooledSpy> spies;
+  spies.reserve(buffer.size());
+  std::size_t fitted = 0;
+  bool exhausted = false;
+
+  auto global_before = global_allocations;
+  while (!exhausted && fitted < buffer.size()) {
+    PooledSpy spy({}, PoolAllocator(&arena));
+    try {
+      spy.setLogger(LargeLogger{&total});
+      spies.push_back(std::move(spy));
+      ++fitted;
+    } catch (const std::bad_alloc&) {
+      exhausted = true;
+    }
+  }
+  check(global_allocations == global_before,
+        "the arena never falls back to the heap");
+  check(exhausted && fitted == buffer.size() / sizeof(LargeLogger),
+        "the arena throws std::bad_alloc once its buffer is used up");
+
+  spies.clear();
+  arena.release();
+  bool reused = true;
+  try {
+    PooledSpy spy({}, PoolAllocator(&arena));
+    spy.setLogger(LargeLogger{&total});
+  } catch (const std::bad_alloc&) {
+    reused = false;
+  }
+  check(reused, "release() makes the buffer available again");
+}
+
+void testPropagation() {
+  CountingResource first_upstream;
+  CountingResource second_upstream;
+  unsigned total = 0;
+
+  {
+    PooledSpy first({1}, PoolAllocator(&first_upstream));
+    PooledSpy second({2}, PoolAllocator(&second_upstream));
+    second.setLogger(LargeLogger{&total});
+
+    first = second;
+    check(first_upstream.allocations() == 0 &&
+              second_upstream.allocations() == 2,
+          "copy assignment allocates from the source's resource");
+
+    PooledSpy third({3}, PoolAllocator(&first_upstream));
+    third.setLogger(LargeLogger{&total});
+    std::swap(first, third);
+    check((*first).n == 3 && (*third).n == 2, "swap exchanges the values");
+
+    auto first_count = first_upstream.allocations();
+    auto second_count = second_upstream.allocations();
+    PooledSpy copy_of_first = first;
+    PooledSpy copy_of_third = third;
+    check(first_upstream.allocations() == first_count + 1 &&
+              second_upstream.allocations() == second_count + 1,
+          "after swap each Spy copies through the resource it came with");
+  }
+
+  check(first_upstream.live() == 0 && second_upstream.live() == 0,
+        "every logger is freed through the resource it came from");
+
+  std::vector<int, ResourceAllocator<int>> a{PoolAllocator(&first_upstream)};
+  std::vector<int, ResourceAllocator<int>> b{PoolAllocator(&second_upstream)};
+  a = b;
+  check(a.get_allocator().resource() == &second_upstream,
+        "containers propagate ResourceAllocator on copy assignment");
+  std::swap(a, b);
+  check(b.get_allocator().resource() == &second_upstream,
+        "containers propagate ResourceAllocator on swap");
+}
+
+}  // namespace
+
+void* operator new(std::size_t size) {
+  ++global_allocations;
+  if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
+
+int main() {
+  testPoolCopies();
+  testArenaExhaustion();
+  testPropagation();
+
+  if (failures == 0) {
+    std::printf("all checks passed\n");
+  }
+  return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+// Sampling policies for Spy. `sample()` is asked once at the first access of
+// every expression. Unsampled expressions are neither counted, timed nor
+// logged; Spy only notes where they end, so that the next expression is
+// asked about afresh.
+
+template <class S>
+concept SamplingPolicy = std::default_initializable<S> && requires(S& s) {
+  { s.sample() } -> std::convertible_to<bool>;
+};
+
+struct SampleAll {
+  static constexpr bool sample() noexcept {
+    return true;
+  }
+};
+
+// Every n-th expression of the Spy, starting with the first one.
+template <std::size_t n>
+  requires(n > 0)
+class SampleEveryNth {
+ public:
+  bool sample() noexcept {
+    if (countdown_ != 0) {
+      --countdown_;
+      return false;
+    }
+    countdown_ = n - 1;
+    return true;
+  }
+
+ private:
+  std::size_t countdown_ = 0;
+};
+
+namespace detail {
+
+// xorshift64* with one state per thread, seeded from a global sequence.
+inline std::uint64_t nextSampleRandom() noexcept {
+  static std::atomic<std::uint64_t> seeds = 0x9e3779b97f4a7c15;
+  thread_local std::uint64_t state =
+      seeds.fetch_add(0x9e3779b97f4a7c15, std::memory_order_relaxed) | 1;
+
+  state ^= state >> 12;
+  state ^= state << 25;
+  state ^= state >> 27;
+  return state * 0x2545f4914f6cdd1d;
+}
+
+}  // namespace detail
+
+// Each expression with probability 1 / one_in.
+template <std::uint64_t one_in>
+  requires(one_in > 0)
+struct SampleRandomly {
+  static bool sample() noexcept {
+    if constexpr (one_in == 1) {
+      return true;
+    } else {
+      return detail::nextSampleRandom() < kThreshold;
+    }
+  }
+
+ private:
+  static constexpr std::uint64_t kThreshold =
+      std::numeric_limits<std::uint64_t>::max() / one_in;
+};
+
+// The first expression after at least `period_us` microseconds since the
+// previous sampled one. Reads the steady clock on every expression.
+template <std::uint64_t period_us>
+class SamplePeriodically {
+  using Clock = std::chrono::steady_clock;
+
+ public:
+  bool sample() noexcept {
+    auto now = Clock::now();
+    if (now < next_) {
+      return false;
+    }
+    next_ = now + std::chrono::microseconds(period_us);
+    return true;
+  }
+
+ private:
+  Clock::time_point next_ = Clock::time_point::min();
+};
@@ -0,0 +1,296 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace detail {
+
+static constexpr std::size_t kSmallBufferSize = 64;
+
+}  // namespace detail
+
+template <class Signature, std::size_t BufferSize = detail::kSmallBufferSize,
+          class Allocator = std::allocator<std::byte>,
+          std::size_t Alignment = alignof(std::max_align_t),
+          bool Copyable = false>
+class SmallFunction;
+
+template <class Signature, std::size_t BufferSize = detail::kSmallBufferSize,
+          class Allocator = std::allocator<std::byte>,
+          std::size_t Alignment = alignof(std::max_align_t)>
+using CopyableSmallFunction =
+    SmallFunction<Signature, BufferSize, Allocator, Alignment, true>;
+
+// Type-erased move-only callable; CopyableSmallFunction is the copyable
+// variant and takes copyable callables only. Everything that depends on the
+// callable type lives in one static table of operations per type. Callables
+// that fit the inline buffer (at least a pointer wide) and cannot throw when
+// moved are stored in place; trivially copyable ones are then moved and
+// copied with memcpy. Other callables are allocated through `Allocator`, so
+// moving never throws.
+template <class R, class... Args, std::size_t BufferSize, class Allocator,
+          std::size_t Alignment, bool Copyable>
+class SmallFunction<R(Args...), BufferSize, Allocator, Alignment, Copyable> {
+  static_assert(std::has_single_bit(Alignment));
+
+  using AllocTraits = std::allocator_traits<Allocator>;
+
+  // Zeroed on construction, so that copying the whole buffer never reads
+  // indeterminate bytes.
+  union Buffer {
+    alignas(Alignment) std::byte stack_[std::max(BufferSize, sizeof(void*))];
+    void* head_;
+  };
+
+  using CopyOperation = void (*)(SmallFunction&, const SmallFunction&);
+
+  struct Operations {
+    R (*call)(Buffer&, Args&&...);
+    void (*destroy)(SmallFunction&);
+    // Constructs the callable of the second function in the first one.
+    CopyOperation copy;
+    // Same, by moving, and destroys the callable of the second function.
+    void (*relocate)(SmallFunction&, SmallFunction&);
+    bool on_stack;
+    // Stored in place and trivially copyable: copies and moves copy the
+    // buffer and destruction is a no-op.
+    bool trivial;
+  };
+
+  template <class F>
+  static constexpr bool kOnStack = sizeof(F) <= sizeof(Buffer) &&
+                                   alignof(F) <= alignof(Buffer) &&
+                                   std::is_nothrow_move_constructible_v<F>;
+
+  template <class F>
+  static constexpr bool kStorable =
+      std::is_invocable_r_v<R, F&, Args...> &&
+      (!Copyable || std::copy_constructible<F>);
+
+  static constexpr bool kNothrowMoveAssignable =
+      AllocTraits::propagate_on_container_move_assignment::value ||
+      AllocTraits::is_always_equal::value;
+
+  template <class F>
+  using FunctorAllocator = typename AllocTraits::template rebind_alloc<F>;
+
+  template <class F>
+  using FunctorAllocTraits = std::allocator_traits<FunctorAllocator<F>>;
+
+ public:
+  SmallFunction(const Allocator& alloc = Allocator()) : alloc_(alloc) {
+  }
+
+  template <class F>
+    requires(!std::same_as<std::remove_cvref_t<F>, SmallFunction> &&
+             kStorable<std::remove_cvref_t<F>>)
+  SmallFunction(F&& f, const Allocator& alloc = Allocator()) : alloc_(alloc) {
+    create<std::remove_cvref_t<F>>(std::forward<F>(f));
+  }
+
+  SmallFunction(const SmallFunction& other)
+    requires Copyable
+      : alloc_(AllocTraits::select_on_container_copy_construction(
+            other.alloc_)) {
+    copyFrom(other);
+  }
+
+  SmallFunction(SmallFunction&& other) noexcept
+      : alloc_(std::move(other.alloc_)) {
+    moveFrom(other, true);
+  }
+
+  SmallFunction& operator=(const SmallFunction& other)
+    requires Copyable
+  {
+    if (this == &other) {
+      return *this;
+    }
+
+    reset();
+
+    if constexpr (AllocTraits::propagate_on_container_copy_assignment::value) {
+      alloc_ = other.alloc_;
+    }
+
+    copyFrom(other);
+
+    return *this;
+  }
+
+  SmallFunction& operator=(SmallFunction&& other) noexcept(
+      kNothrowMoveAssignable) {
+    if (this == &other) {
+      return *this;
+    }
+
+    reset();
+
+    if constexpr (AllocTraits::propagate_on_container_move_assignment::value) {
+      alloc_ = std::move(other.alloc_);
+      moveFrom(other, true);
+    } else {
+      moveFrom(other, alloc_ == other.alloc_);
+    }
+
+    return *this;
+  }
+
+  ~SmallFunction() {
+    reset();
+  }
+
+  // Replaces the callable, keeping the allocator.
+  template <class F>
+    requires kStorable<std::remove_cvref_t<F>>
+  void emplace(F&& f) {
+    reset();
+    create<std::remove_cvref_t<F>>(std::forward<F>(f));
+  }
+
+  void reset() {
+    if (ops_ != nullptr) {
+      if (!ops_->trivial) {
+        ops_->destroy(*this);
+      }
+      ops_ = nullptr;
+    }
+  }
+
+  explicit operator bool() const {
+    return ops_ != nullptr;
+  }
+
+  // Calling an empty function is undefined.
+  R operator()(Args... args) {
+    assert(ops_ != nullptr);
+    return ops_->call(buffer_, std::forward<Args>(args)...);
+  }
+
+ private:
+  template <class F>
+  static F* functorPtr(Buffer& buffer) {
+    if constexpr (kOnStack<F>) {
+      return std::launder(reinterpret_cast<F*>(buffer.stack_));
+    } else {
+      return static_cast<F*>(buffer.head_);
+    }
+  }
+
+  template <class F>
+  static const F* functorPtr(const Buffer& buffer) {
+    return functorPtr<F>(const_cast<Buffer&>(buffer));
+  }
+
+  template <class F, class... CtorArgs>
+  void create(CtorArgs&&... args) {
+    FunctorAllocator<F> alloc(alloc_);
+
+    if constexpr (kOnStack<F>) {
+      FunctorAllocTraits<F>::construct(alloc,
+                                       reinterpret_cast<F*>(buffer_.stack_),
+                                       std::forward<CtorArgs>(args)...);
+    } else {
+      auto* ptr = FunctorAllocTraits<F>::allocate(alloc, 1);
+      FunctorAllocTraits<F>::construct(alloc, ptr,
+                                       std::forward<CtorArgs>(args)...);
+      buffer_.head_ = ptr;
+    }
+
+    ops_ = &kOperations<F>;
+  }
+
+  template <class F>
+  static R callFunctor(Buffer& buffer, Args&&... args) {
+    if constexpr (std::is_void_v<R>) {
+      std::invoke(*functorPtr<F>(buffer), std::forward<Args>(args)...);
+    } else {
+      return std::invoke(*functorPtr<F>(buffer), std::forward<Args>(args)...);
+    }
+  }
+
+  template <class F>
+  static void destroyFunctor(SmallFunction& self) {
+    FunctorAllocator<F> alloc(self.alloc_);
+    auto* ptr = functorPtr<F>(self.buffer_);
+
+    FunctorAllocTraits<F>::destroy(alloc, ptr);
+    if constexpr (!kOnStack<F>) {
+      FunctorAllocTraits<F>::deallocate(alloc, ptr, 1);
+    }
+  }
+
+  template <class F>
+  static void copyFunctor(SmallFunction& self, const SmallFunction& other) {
+    self.create<F>(*functorPtr<F>(other.buffer_));
+  }
+
+  template <class F>
+  static constexpr CopyOperation copyOperation() {
+    if constexpr (Copyable) {
+      return &copyFunctor<F>;
+    } else {
+      return nullptr;
+    }
+  }
+
+  template <class F>
+  static void relocateFunctor(SmallFunction& self, SmallFunction& other) {
+    self.create<F>(std::move(*functorPtr<F>(other.buffer_)));
+    destroyFunctor<F>(other);
+  }
+
+  template <class F>
+  static constexpr Operations kOperations = {
+      &callFunctor<F>,
+      &destroyFunctor<F>,
+      copyOperation<F>(),
+      &relocateFunctor<F>,
+      kOnStack<F>,
+      kOnStack<F> && std::is_trivially_copyable_v<F>,
+  };
+
+  void copyFrom(const SmallFunction& other) {
+    if (other.ops_ == nullptr) {
+      return;
+    }
+
+    if (other.ops_->trivial) {
+      buffer_ = other.buffer_;
+      ops_ = other.ops_;
+    } else {
+      other.ops_->copy(*this, other);
+    }
+  }
+
+  // Heap callables change owner when the allocators agree; other
+  // non-trivial ones are moved into storage of this function, which only
+  // allocates, and so may throw, for unequal allocators.
+  void moveFrom(SmallFunction& other, bool same_allocator) {
+    if (other.ops_ == nullptr) {
+      return;
+    }
+
+    if (other.ops_->trivial || (!other.ops_->on_stack && same_allocator)) {
+      buffer_ = other.buffer_;
+      ops_ = other.ops_;
+    } else {
+      other.ops_->relocate(*this, other);
+    }
+
+    other.ops_ = nullptr;
+  }
+
+ private:
+  [[no_unique_address]] Allocator alloc_;
+  const Operations* ops_ = nullptr;
+  Buffer buffer_{};
+};
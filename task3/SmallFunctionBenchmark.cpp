@@ -0,0 +1,93 @@
+// Compares SmallFunction with std::function and, where the library has it,
+// std::move_only_function: constructing from a lambda, moving the wrapper
+// around and calling it, for a trivially copyable capture, a capture with a
+// non-trivial member and a capture larger than every inline buffer.
+//
+// Build with optimizations, e.g.
+//   g++ -std=c++23 -O2 -I. SmallFunctionBenchmark.cpp
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <utility>
+
+#include <SmallFunction.hpp>
+
+namespace {
+
+static constexpr std::size_t kIterations = 1 << 20;
+
+template <class T>
+void doNotOptimize(const T& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+template <class F>
+double nsPerIteration(F&& f) {
+  auto start = std::chrono::steady_clock::now();
+
+  for (std::size_t i = 0; i < kIterations; ++i) {
+    f(static_cast<int>(i));
+  }
+
+  std::chrono::duration<double, std::nano> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count() / kIterations;
+}
+
+auto trivialCallable() {
+  return [a = 1, b = 2](int x) { return x * a + b; };
+}
+
+auto nonTrivialCallable() {
+  return [p = std::make_shared<int>(3)](int x) { return x + *p; };
+}
+
+auto largeCallable() {
+  std::array<int, 32> values{};
+  values.fill(1);
+  return [values](int x) { return x + values[x & 31]; };
+}
+
+template <class Function, class Make>
+void runCase(const char* name, Make make) {
+  double construct = nsPerIteration([&](int) {
+    Function f(make());
+    doNotOptimize(f);
+  });
+
+  Function source(make());
+  double move = nsPerIteration([&](int) {
+    Function f(std::move(source));
+    source = std::move(f);
+    doNotOptimize(source);
+  });
+
+  double call = nsPerIteration([&](int x) { doNotOptimize(source(x)); });
+
+  std::printf("%-22s %9.2f %9.2f %9.2f\n", name, construct, move, call);
+}
+
+template <class Make>
+void runCallable(const char* callable, Make make) {
+  std::printf("%s\n", callable);
+  runCase<SmallFunction<int(int)>>("  SmallFunction<64>", make);
+  runCase<SmallFunction<int(int), 16>>("  SmallFunction<16>", make);
+  runCase<std::function<int(int)>>("  std::function", make);
+#ifdef __cpp_lib_move_only_function
+  runCase<std::move_only_function<int(int)>>("  move_only_function", make);
+#endif
+}
+
+}  // namespace
+
+int main() {
+  std::printf("%-22s %9s %9s %9s   (ns per iteration)\n", "", "construct",
+              "move", "call");
+  runCallable("trivial capture", trivialCallable);
+  runCallable("shared_ptr capture", nonTrivialCallable);
+  runCallable("128-byte capture", largeCallable);
+}
@@ -1,10 +1,16 @@
 #pragma once
 
 #include <concepts>
+#include <cstddef>
 #include <cstring>
 #include <functional>
+#include <memory>
 #include <utility>
 
+#include <Sampling.hpp>
+#include <SmallFunction.hpp>
+#include <Timing.hpp>
+
 namespace detail {
 
 template <class... Args>
@@ -28,287 +34,54 @@ struct Functor : VoidCallable<Args...> {
   F f;
 };
 
-static constexpr std::size_t kSmallBufferSize = 64;
-
-template <class Allocator>
-class LoggerWrapper {
-  using LogPtr = void (LoggerWrapper::*)(unsigned);
-  using DestroyPtr = void (LoggerWrapper::*)();
-  using CopyPtr = void (LoggerWrapper::*)(const LoggerWrapper&);
-  using MovePtr = void (LoggerWrapper::*)(LoggerWrapper&);
-
- public:
-  template <std::invocable<unsigned> Logger>
-  void wrapLogger(Logger&& logger) {
-    if (destroy_ptr_ != nullptr) {
-      (this->*destroy_ptr_)();
-    }
-
-    destroy_ptr_ = &LoggerWrapper::destroyLogger<Logger>;
-
-    if constexpr (std::copyable<Logger>) {
-      copy_ptr_ = &LoggerWrapper::copyLogger<Logger>;
-    }
-
-    move_ptr_ = &LoggerWrapper::moveLogger<Logger>;
-
-    createLogger(std::forward<Logger>(logger));
-  }
-
-  void wrapLogger() {
-    if (destroy_ptr_ != nullptr) {
-      (this->*destroy_ptr_)();
-    }
-  }
-
-  LoggerWrapper(const Allocator& alloc) : alloc_(alloc) {
-    logger_.head_ = nullptr;
-  }
-
-  LoggerWrapper(const LoggerWrapper& other)
-      : alloc_(std::allocator_traits<
-               Allocator>::select_on_container_copy_construction(other.alloc_)),
-        destroy_ptr_(other.destroy_ptr_),
-        copy_ptr_(other.copy_ptr_),
-        move_ptr_(other.move_ptr_) {
-    if (copy_ptr_ != nullptr) {
-      (this->*copy_ptr_)(other);
-    }
-  }
-
-  LoggerWrapper(LoggerWrapper&& other)
-      : alloc_(std::move(other.alloc_)),
-        destroy_ptr_(std::exchange(other.destroy_ptr_, nullptr)),
-        copy_ptr_(std::exchange(other.copy_ptr_, nullptr)),
-        move_ptr_(std::exchange(other.move_ptr_, nullptr)) {
-    if (move_ptr_ != nullptr) {
-      (this->*move_ptr_)(other);
-    }
-  }
-
-  LoggerWrapper& operator=(const LoggerWrapper& other) {
-    if (this == &other) {
-      return *this;
-    }
-
-    if (destroy_ptr_ != nullptr) {
-      (this->*destroy_ptr_)();
-    }
-
-    if constexpr (std::allocator_traits<Allocator>::
-                      propagate_on_container_copy_assignment::value) {
-      alloc_ = other.alloc_;
-    }
-
-    destroy_ptr_ = other.destroy_ptr_;
-    copy_ptr_ = other.copy_ptr_;
-    move_ptr_ = other.move_ptr_;
-
-    if (copy_ptr_ != nullptr) {
-      (this->*copy_ptr_)(other);
-    }
-
-    return *this;
-  }
-
-  LoggerWrapper& operator=(LoggerWrapper&& other) {
-    if (this == &other) {
-      return *this;
-    }
+// Copyable exactly when the spied type is, matching setLogger: copyable
+// objects take copyable loggers only.
+template <class T, class Allocator, std::size_t BufferSize = kSmallBufferSize,
+          std::size_t Alignment = alignof(std::max_align_t)>
+using LoggerWrapper = SmallFunction<void(unsigned), BufferSize, Allocator,
+                                    Alignment, std::copy_constructible<T>>;
 
-    if (destroy_ptr_ != nullptr) {
-      (this->*destroy_ptr_)();
-    }
-
-    destroy_ptr_ = std::exchange(other.destroy_ptr_, nullptr);
-    copy_ptr_ = std::exchange(other.copy_ptr_, nullptr);
-    move_ptr_ = std::exchange(other.move_ptr_, nullptr);
-
-    if (move_ptr_ != nullptr) {
-      (this->*move_ptr_)(other);
-    }
-
-    return *this;
-  }
-
-  ~LoggerWrapper() {
-    if (destroy_ptr_ != nullptr) {
-      (this->*destroy_ptr_)();
-    }
-  }
-
-  void operator()(unsigned v) {
-    if (call_ptr_ != nullptr) {
-      (this->*call_ptr_)(v);
-    }
-  }
-
- private:
-  template <std::invocable<unsigned> Logger>
-  void callLogger(unsigned v) {
-    if constexpr (sizeof(Logger) > kSmallBufferSize) {
-      std::invoke(
-          *reinterpret_cast<std::remove_reference_t<Logger>*>(logger_.head_),
-          v);
-    } else {
-      std::invoke(
-          *reinterpret_cast<std::remove_reference_t<Logger>*>(logger_.stack_),
-          v);
-    }
-  }
-
-  template <std::invocable<unsigned> Logger>
-  void copyLogger(const LoggerWrapper& other) {
-    if constexpr (sizeof(Logger) > kSmallBufferSize) {
-      Logger copy = *reinterpret_cast<const Logger*>(other.logger_.head_);
-      createLogger<Logger>(std::move(copy));
-    } else {
-      Logger copy = *reinterpret_cast<const Logger*>(other.logger_.stack_);
-      createLogger<Logger>(std::move(copy));
-    }
-  }
-
-  template <std::invocable<unsigned> Logger>
-  void moveLogger(LoggerWrapper& other) {
-    if constexpr (std::allocator_traits<Allocator>::
-                      propagate_on_container_move_assignment::value) {
-      alloc_ = std::move(other.alloc_);
-
-      if constexpr (sizeof(Logger) > kSmallBufferSize) {
-        logger_.head_ = other.logger_.head_;
-        call_ptr_ = &LoggerWrapper::callLogger<Logger>;
-      } else {
-        createLogger(
-            std::move(*reinterpret_cast<std::remove_reference_t<Logger>*>(
-                other.logger_.stack_)));
-      }
-    } else {
-      if (alloc_ == other.alloc_) {
-        if constexpr (sizeof(Logger) > kSmallBufferSize) {
-          logger_.head_ = other.logger_.head_;
-          call_ptr_ = &LoggerWrapper::callLogger<Logger>;
-        } else {
-          createLogger(
-              std::move(*reinterpret_cast<Logger*>(other.logger_.stack_)));
-        }
-      } else {
-        alloc_ = std::move(other.alloc_);
-
-        if constexpr (sizeof(Logger) > kSmallBufferSize) {
-          createLogger(
-              std::move(*reinterpret_cast<Logger*>(other.logger_.head_)));
-          std::allocator_traits<Allocator>::deallocate(
-              alloc_, other.logger_.head_, sizeof(Logger));
-        } else {
-          createLogger(
-              std::move(*reinterpret_cast<Logger*>(other.logger_.stack_)));
-        }
-      }
-    }
-
-    other.logger_.head_ = nullptr;
-  }
-
-  template <std::invocable<unsigned> Logger>
-  void createLogger(Logger&& logger) {
-    logger_.head_ =
-        std::allocator_traits<Allocator>::allocate(alloc_, sizeof(Logger));
-    std::allocator_traits<Allocator>::construct(
-        alloc_,
-        reinterpret_cast<std::remove_reference_t<Logger>*>(logger_.head_),
-        std::forward<Logger>(logger));
-
-    call_ptr_ = &LoggerWrapper::callLogger<std::remove_reference_t<Logger>>;
-  }
-
-  template <std::invocable<unsigned> Logger>
-    requires(sizeof(Logger) <= kSmallBufferSize)
-  void createLogger(Logger&& logger) {
-    std::allocator_traits<Allocator>::construct(
-        alloc_,
-        reinterpret_cast<std::remove_reference_t<Logger>*>(logger_.stack_),
-        std::forward<Logger>(logger));
-
-    call_ptr_ = &LoggerWrapper::callLogger<Logger>;
-  }
-
-  template <std::invocable<unsigned> Logger>
-  void destroyLogger() {
-    if (logger_.head_ != nullptr) {
-      std::allocator_traits<Allocator>::destroy(
-          alloc_,
-          reinterpret_cast<std::remove_reference_t<Logger>*>(logger_.head_));
-      std::allocator_traits<Allocator>::deallocate(alloc_, logger_.head_,
-                                                   sizeof(Logger));
-    }
-    logger_.head_ = nullptr;
-    call_ptr_ = nullptr;
-  }
-
-  template <std::invocable<unsigned> Logger>
-    requires(sizeof(Logger) <= kSmallBufferSize)
-  void destroyLogger() {
-    if (call_ptr_ != nullptr) {
-      std::allocator_traits<Allocator>::destroy(
-          alloc_,
-          reinterpret_cast<std::remove_reference_t<Logger>*>(logger_.stack_));
-    }
-    logger_.head_ = nullptr;
-    call_ptr_ = nullptr;
-  }
-
- private:
-  union Buffer {
-    std::byte* head_;
-    std::byte stack_[kSmallBufferSize];
-  };
-
- private:
-  Allocator alloc_;
-
-  DestroyPtr destroy_ptr_ = nullptr;
-  CopyPtr copy_ptr_ = nullptr;
-  MovePtr move_ptr_ = nullptr;
-  LogPtr call_ptr_ = nullptr;
-
-  Buffer logger_;
-};
-
-template <class T, std::invocable<unsigned> Logger>
+// Returned by Spy::operator->; all wrappers of one expression report to the
+// same Spy, and the first of them to be destroyed ends the expression.
+template <class T, class Spy>
 class LifetimeWrapper {
  public:
-  explicit LifetimeWrapper(T* value_ptr, Logger& logger, unsigned& ref_cnt,
-                           bool& new_lifetime)
-      : value_ptr_(value_ptr),
-        logger_(logger),
-        ref_cnt_(ref_cnt),
-        new_lifetime_(new_lifetime) {
+  explicit LifetimeWrapper(T* value_ptr, Spy& spy)
+      : value_ptr_(value_ptr), spy_(spy) {
   }
 
   ~LifetimeWrapper() {
-    if (!new_lifetime_) {
-      logger_(ref_cnt_);
-      new_lifetime_ = true;
-      ref_cnt_ = 0;
-    }
+    spy_.endExpression();
   }
 
   T* operator->() {
-    ++ref_cnt_;
+    if (spy_.sampled_) {
+      ++spy_.ref_cnt_;
+    }
     return value_ptr_;
   }
 
  private:
   T* value_ptr_;
-  Logger& logger_;
-  unsigned& ref_cnt_;
-  bool& new_lifetime_;
+  Spy& spy_;
 };
 
 }  // namespace detail
 
-template <class T, class Allocator = std::allocator<std::byte>>
+// `BufferSize` and `Alignment` bound the loggers stored inside the Spy;
+// larger ones are allocated through `Allocator`. `Sampling` decides which
+// expressions are logged, see Sampling.hpp; `Timing` measures the sampled
+// ones, see Timing.hpp.
+template <class T, class Allocator = std::allocator<std::byte>,
+          std::size_t BufferSize = detail::kSmallBufferSize,
+          std::size_t Alignment = alignof(std::max_align_t),
+          SamplingPolicy Sampling = SampleAll, TimingPolicy Timing = NoTiming>
 class Spy {
+  using Wrapper = detail::LoggerWrapper<T, Allocator, BufferSize, Alignment>;
+
+  template <class U, class S>
+  friend class detail::LifetimeWrapper;
+
  public:
   explicit Spy(T value, const Allocator& alloc = Allocator())
       : value_(std::move(value)), wrapper_(alloc) {
@@ -367,19 +140,27 @@ class Spy {
     return value_;
   }
 
-  detail::LifetimeWrapper<T, detail::LoggerWrapper<Allocator>> operator->() {
-    new_lifetime_ = false;
-    return detail::LifetimeWrapper(&value_, wrapper_, ref_cnt_, new_lifetime_);
+  detail::LifetimeWrapper<T, Spy> operator->() {
+    if (new_lifetime_) {
+      new_lifetime_ = false;
+      sampled_ = sampling_.sample();
+      if (sampled_) {
+        started_ = timing_.start();
+      }
+    }
+    return detail::LifetimeWrapper<T, Spy>(&value_, *this);
   }
 
-  template <std::equality_comparable_with<T> U, class AllocatorOther>
-  bool operator==(const Spy<U, AllocatorOther>& other) const {
+  template <std::equality_comparable_with<T> U, class AllocatorOther,
+            class SamplingOther, class TimingOther>
+  bool operator==(const Spy<U, AllocatorOther, BufferSize, Alignment,
+                            SamplingOther, TimingOther>& other) const {
     return value_ == other.value_;
   }
 
   // Resets logger
   void setLogger() {
-    wrapper_.wrapLogger();
+    wrapper_.reset();
   }
 
   template <std::invocable<unsigned> Logger>
@@ -388,12 +169,34 @@ class Spy {
              !std::copy_constructible<T>) ||
             (std::copy_constructible<Logger> && std::copy_constructible<T>)
   {
-    wrapper_.wrapLogger(std::forward<Logger>(logger));
+    wrapper_.emplace(std::forward<Logger>(logger));
+  }
+
+ private:
+  void endExpression() {
+    if (new_lifetime_) {
+      return;
+    }
+    new_lifetime_ = true;
+
+    if (!sampled_) {
+      return;
+    }
+
+    timing_.finish(started_, ref_cnt_, &value_);
+    if (wrapper_) {
+      wrapper_(ref_cnt_);
+    }
+    ref_cnt_ = 0;
   }
 
  private:
   T value_;
-  detail::LoggerWrapper<Allocator> wrapper_;
+  Wrapper wrapper_;
   unsigned ref_cnt_ = 0;
   bool new_lifetime_ = true;
+  bool sampled_ = false;
+  [[no_unique_address]] Sampling sampling_;
+  [[no_unique_address]] Timing timing_;
+  [[no_unique_address]] typename Timing::Stamp started_{};
 };
\ No newline at end of file
@@ -0,0 +1,166 @@
+// Measures the cost of Spy against plain access to the same object:
+// operator-> and operator* without a logger, with a logger in the inline
+// buffer and with one on the heap, copies, moves and setLogger, with
+// std::allocator and with a FixedPool behind ResourceAllocator, for values
+// of 4, 64 and 1024 bytes. Every row is also given relative to a raw
+// pointer access in the same value type.
+//
+// Build with optimizations, e.g.
+//   g++ -std=c++20 -O2 -I. SpyBenchmark.cpp
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <utility>
+
+#include <MemoryResources.hpp>
+#include <Spy.hpp>
+
+namespace {
+
+static constexpr std::size_t kIterations = 1 << 20;
+
+template <class T>
+void doNotOptimize(const T& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+template <std::size_t n>
+struct Value {
+  int get() const {
+    return data[0];
+  }
+
+  bool operator==(const Value&) const = default;
+
+  std::array<int, n> data{};
+};
+
+template <class F>
+double nsPerIteration(F&& f) {
+  auto start = std::chrono::steady_clock::now();
+
+  for (std::size_t i = 0; i < kIterations; ++i) {
+    f();
+  }
+
+  std::chrono::duration<double, std::nano> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count() / kIterations;
+}
+
+struct SmallLogger {
+  void operator()(unsigned count) const {
+    *total += count;
+  }
+
+  unsigned* total;
+};
+
+struct LargeLogger {
+  void operator()(unsigned count) const {
+    *total += count + padding[count & 127];
+  }
+
+  unsigned* total;
+  std::array<unsigned char, 128> padding{};
+};
+
+void report(const char* name, double ns, double raw_ns) {
+  std::printf("  %-34s %9.2f %9.2fx\n", name, ns, ns / raw_ns);
+}
+
+template <class Spy>
+void runLoggerCases(const char* name, Spy& spy, double raw_ns) {
+  char label[64];
+
+  std::snprintf(label, sizeof(label), "operator-> %s", name);
+  report(label, nsPerIteration([&] { doNotOptimize(spy->get()); }), raw_ns);
+
+  std::snprintf(label, sizeof(label), "copy %s", name);
+  report(label, nsPerIteration([&] {
+           Spy copy = spy;
+           doNotOptimize(copy);
+         }),
+         raw_ns);
+
+  std::snprintf(label, sizeof(label), "move %s", name);
+  report(label, nsPerIteration([&] {
+           Spy moved = std::move(spy);
+           spy = std::move(moved);
+           doNotOptimize(spy);
+         }),
+         raw_ns);
+}
+
+template <class Spy, class Allocator, class Logger>
+void runSetLogger(const char* name, const Allocator& alloc, Logger logger,
+                  double raw_ns) {
+  Spy spy({}, alloc);
+  report(name, nsPerIteration([&] {
+           spy.setLogger(logger);
+           doNotOptimize(spy);
+         }),
+         raw_ns);
+}
+
+template <std::size_t n>
+void runValue() {
+  using T = Value<n>;
+  using PoolAllocator = ResourceAllocator<std::byte>;
+
+  std::printf("%zu-byte value\n", sizeof(T));
+
+  unsigned total = 0;
+  FixedPool pool(sizeof(LargeLogger));
+  PoolAllocator pool_alloc(&pool);
+
+  T raw_value{};
+  T* raw = &raw_value;
+  doNotOptimize(raw);
+  double raw_ns = nsPerIteration([&] { doNotOptimize(raw->get()); });
+  report("raw pointer ->", raw_ns, raw_ns);
+
+  Spy<T> spy;
+  report("operator-> no logger",
+         nsPerIteration([&] { doNotOptimize(spy->get()); }), raw_ns);
+  report("operator*", nsPerIteration([&] { doNotOptimize((*spy).get()); }),
+         raw_ns);
+
+  Spy<T, std::allocator<std::byte>, 64, alignof(std::max_align_t),
+      SampleEveryNth<64>>
+      sampled;
+  sampled.setLogger(SmallLogger{&total});
+  report("operator-> small, every 64th",
+         nsPerIteration([&] { doNotOptimize(sampled->get()); }), raw_ns);
+
+  spy.setLogger(SmallLogger{&total});
+  runLoggerCases("small logger", spy, raw_ns);
+
+  spy.setLogger(LargeLogger{&total});
+  runLoggerCases("large logger", spy, raw_ns);
+
+  Spy<T, PoolAllocator> pooled(pool_alloc);
+  pooled.setLogger(LargeLogger{&total});
+  runLoggerCases("large logger, pool", pooled, raw_ns);
+
+  runSetLogger<Spy<T>>("setLogger small", std::allocator<std::byte>(),
+                       SmallLogger{&total}, raw_ns);
+  runSetLogger<Spy<T>>("setLogger large", std::allocator<std::byte>(),
+                       LargeLogger{&total}, raw_ns);
+  runSetLogger<Spy<T, PoolAllocator>>("setLogger large, pool", pool_alloc,
+                                      LargeLogger{&total}, raw_ns);
+
+  doNotOptimize(total);
+}
+
+}  // namespace
+
+int main() {
+  std::printf("  %-34s %9s %10s\n", "", "ns", "vs raw");
+  runValue<1>();
+  runValue<16>();
+  runValue<256>();
+}
@@ -0,0 +1,252 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Timing policies for Spy. `start()` is called when a sampled expression
+// makes its first access and `finish()` when the expression ends, with the
+// number of accesses and the spied object.
+
+template <class T>
+concept TimingPolicy = std::default_initializable<T> &&
+                       requires(T& t, typename T::Stamp stamp) {
+                         { t.start() } -> std::same_as<typename T::Stamp>;
+                         t.finish(stamp, 0u, static_cast<const void*>(nullptr));
+                       };
+
+struct NoTiming {
+  struct Stamp {};
+
+  static constexpr Stamp start() noexcept {
+    return {};
+  }
+
+  static constexpr void finish(Stamp, unsigned, const void*) noexcept {
+  }
+};
+
+// Trace clocks count ticks from an arbitrary origin.
+struct SteadyTraceClock {
+  static std::uint64_t now() noexcept {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+  }
+
+  static double ticksPerMicrosecond() {
+    return 1000.0;
+  }
+};
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// Time stamp counter: a few cycles to read instead of a clock call. The tick
+// rate is measured against the steady clock between the first use and the
+// export, so it assumes an invariant TSC.
+struct TscTraceClock {
+  static std::uint64_t now() noexcept {
+    static_cast<void>(origin());
+    return __rdtsc();
+  }
+
+  static double ticksPerMicrosecond() {
+    auto [tsc, steady] = origin();
+    auto min_elapsed = std::chrono::milliseconds(10);
+
+    while (std::chrono::steady_clock::now() - steady < min_elapsed) {
+    }
+
+    std::chrono::duration<double, std::micro> elapsed =
+        std::chrono::steady_clock::now() - steady;
+    return static_cast<double>(__rdtsc() - tsc) / elapsed.count();
+  }
+
+ private:
+  struct Origin {
+    std::uint64_t tsc;
+    std::chrono::steady_clock::time_point steady;
+  };
+
+  static const Origin& origin() noexcept {
+    static const Origin origin = {__rdtsc(), std::chrono::steady_clock::now()};
+    return origin;
+  }
+};
+
+#endif
+
+struct TraceEvent {
+  std::uint64_t begin;
+  std::uint64_t end;
+  unsigned accesses;
+  const void* object;
+};
+
+// Collects trace events in fixed-size per-thread ring buffers. Recording
+// never locks: a thread appends to its own buffer and publishes the new
+// size, so export can run while other threads record. Export and clear()
+// empty the buffers. While a buffer is full, that is after 65536 events
+// since the last export or clear() on its thread, further events from the
+// thread are dropped and counted.
+template <class Clock>
+class TraceRecorder {
+  static constexpr std::size_t kBufferEvents = 1 << 16;
+
+  // Event i lives at events[i % kBufferEvents]; [consumed, size) are the
+  // events not exported yet. Only the owning thread advances `size`, and
+  // only export and clear() advance `consumed`, under the registry mutex.
+  struct Buffer {
+    std::unique_ptr<TraceEvent[]> events =
+        std::make_unique<TraceEvent[]>(kBufferEvents);
+    std::atomic<std::size_t> size = 0;
+    std::atomic<std::size_t> consumed = 0;
+    std::atomic<std::size_t> dropped = 0;
+  };
+
+  struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<Buffer>> buffers;
+  };
+
+ public:
+  static void record(const TraceEvent& event) {
+    thread_local Buffer& buffer = registerThread();
+
+    auto size = buffer.size.load(std::memory_order_relaxed);
+    if (size - buffer.consumed.load(std::memory_order_acquire) ==
+        kBufferEvents) {
+      buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+
+    buffer.events[size % kBufferEvents] = event;
+    buffer.size.store(size + 1, std::memory_order_release);
+  }
+
+  // Discards the events not exported yet and the count of dropped ones.
+  static void clear() {
+    std::scoped_lock lock(registry().mutex);
+
+    for (auto& buffer : registry().buffers) {
+      buffer->consumed.store(buffer->size.load(std::memory_order_acquire),
+                             std::memory_order_release);
+      buffer->dropped.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  static std::size_t dropped() {
+    std::scoped_lock lock(registry().mutex);
+
+    std::size_t result = 0;
+    for (auto& buffer : registry().buffers) {
+      result += buffer->dropped.load(std::memory_order_relaxed);
+    }
+    return result;
+  }
+
+  // Writes the events recorded since the previous export or clear() in the
+  // Chrome trace-event format, as complete ("X") events with one track per
+  // recording thread, and removes them from the buffers. Timestamps are
+  // microseconds since the earliest event written.
+  static void writeChromeTrace(std::ostream& out) {
+    auto ticks_per_us = Clock::ticksPerMicrosecond();
+    std::scoped_lock lock(registry().mutex);
+
+    auto& buffers = registry().buffers;
+    std::vector<std::size_t> begins;
+    std::vector<std::size_t> ends;
+    auto origin = std::numeric_limits<std::uint64_t>::max();
+
+    for (auto& buffer : buffers) {
+      begins.push_back(buffer->consumed.load(std::memory_order_relaxed));
+      ends.push_back(buffer->size.load(std::memory_order_acquire));
+      for (auto i = begins.back(); i < ends.back(); ++i) {
+        origin = std::min(origin, buffer->events[i % kBufferEvents].begin);
+      }
+    }
+
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+
+    bool first = true;
+    char line[256];
+
+    for (std::size_t tid = 0; tid < buffers.size(); ++tid) {
+      for (auto i = begins[tid]; i < ends[tid]; ++i) {
+        const auto& event = buffers[tid]->events[i % kBufferEvents];
+
+        std::snprintf(line, sizeof(line),
+                      "%s{\"name\":\"expression\",\"ph\":\"X\",\"pid\":0,"
+                      "\"tid\":%zu,\"ts\":",
+                      first ? "" : ",", tid);
+        out << line;
+        writeMicroseconds(out, (event.begin - origin) / ticks_per_us);
+        out << ",\"dur\":";
+        writeMicroseconds(out, (event.end - event.begin) / ticks_per_us);
+        std::snprintf(line, sizeof(line),
+                      ",\"args\":{\"accesses\":%u,\"object\":\"%p\"}}",
+                      event.accesses, event.object);
+        out << line;
+        first = false;
+      }
+      buffers[tid]->consumed.store(ends[tid], std::memory_order_release);
+    }
+
+    out << "]}\n";
+  }
+
+  static bool writeChromeTrace(const char* path) {
+    std::ofstream out(path);
+    writeChromeTrace(out);
+    return static_cast<bool>(out);
+  }
+
+ private:
+  // std::to_chars rather than printf, whose decimal point follows the locale.
+  static void writeMicroseconds(std::ostream& out, double us) {
+    char digits[64];
+    auto [end, ec] = std::to_chars(digits, digits + sizeof(digits), us,
+                                   std::chars_format::fixed, 3);
+    out.write(digits, end - digits);
+  }
+
+  static Registry& registry() {
+    static Registry registry;
+    return registry;
+  }
+
+  static Buffer& registerThread() {
+    std::scoped_lock lock(registry().mutex);
+    return *registry().buffers.emplace_back(std::make_unique<Buffer>());
+  }
+};
+
+// Records the time from the first access of an expression to its end into
+// TraceRecorder<Clock>.
+template <class Clock = SteadyTraceClock>
+struct TraceTiming {
+  using Stamp = std::uint64_t;
+
+  static Stamp start() noexcept {
+    return Clock::now();
+  }
+
+  static void finish(Stamp begin, unsigned accesses, const void* object) {
+    TraceRecorder<Clock>::record({begin, Clock::now(), accesses, object});
+  }
+};
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+
+#include <EnumeratorTraits.hpp>
+
+// Containers keyed by the enumerators of `Enum`. Keys are stored by their
+// ordinal, the position of the enumerator in `Traits`, so sparse and negative
+// values take no extra space. Keys that are not enumerators of `Enum` are a
+// precondition violation except for `find`, `contains` and `erase`.
+
+template <class Enum, class V, class Traits = EnumeratorTraits<Enum>>
+  requires std::is_enum_v<Enum>
+class EnumMap {
+ public:
+  static constexpr std::size_t size() noexcept {
+    return Traits::size();
+  }
+
+  V& operator[](Enum key) noexcept {
+    return values_[*Traits::indexOf(key)];
+  }
+
+  const V& operator[](Enum key) const noexcept {
+    return values_[*Traits::indexOf(key)];
+  }
+
+  V* find(Enum key) noexcept {
+    auto i = Traits::indexOf(key);
+    return i ? &values_[*i] : nullptr;
+  }
+
+  const V* find(Enum key) const noexcept {
+    auto i = Traits::indexOf(key);
+    return i ? &values_[*i] : nullptr;
+  }
+
+  // Calls `f(key, value)` for every enumerator in ascending order of value.
+  template <class F>
+  void forEach(F&& f) {
+    for (std::size_t i = 0; i < size(); ++i) {
+      f(Traits::at(i), values_[i]);
+    }
+  }
+
+  template <class F>
+  void forEach(F&& f) const {
+    for (std::size_t i = 0; i < size(); ++i) {
+      f(Traits::at(i), values_[i]);
+    }
+  }
+
+  bool operator==(const EnumMap& other) const = default;
+
+ private:
+  std::array<V, Traits::size()> values_{};
+};
+
+template <class Enum, class Traits = EnumeratorTraits<Enum>>
+  requires std::is_enum_v<Enum>
+class EnumSet {
+  using Word = std::uint64_t;
+
+  static constexpr std::size_t kWordBits = 64;
+  static constexpr std::size_t kWords =
+      (Traits::size() + kWordBits - 1) / kWordBits;
+
+ public:
+  // Visits set bits with countr_zero, skipping empty words.
+  class Iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Enum;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const Enum*;
+    using reference = Enum;
+
+   public:
+    Iterator() = default;
+
+    Iterator(const EnumSet* set, std::size_t word) : set_(set), word_(word) {
+      loadWord();
+    }
+
+    Enum operator*() const {
+      return Traits::at(word_ * kWordBits + std::countr_zero(bits_));
+    }
+
+    Iterator& operator++() {
+      bits_ &= bits_ - 1;
+      if (bits_ == 0) {
+        ++word_;
+        loadWord();
+      }
+      return *this;
+    }
+
+    Iterator operator++(int) {
+      Iterator copy = *this;
+      ++*this;
+      return copy;
+    }
+
+    bool operator==(const Iterator& other) const {
+      return word_ == other.word_ && bits_ == other.bits_;
+    }
+
+   private:
+    // Loads the first non-empty word starting from `word_`.
+    void loadWord() {
+      while (word_ < kWords && (bits_ = set_->words_[word_]) == 0) {
+        ++word_;
+      }
+    }
+
+   private:
+    const EnumSet* set_ = nullptr;
+    std::size_t word_ = kWords;
+    Word bits_ = 0;
+  };
+
+ public:
+  static constexpr std::size_t capacity() noexcept {
+    return Traits::size();
+  }
+
+  std::size_t size() const noexcept {
+    std::size_t result = 0;
+    for (Word word : words_) {
+      result += std::popcount(word);
+    }
+    return result;
+  }
+
+  bool empty() const noexcept {
+    for (Word word : words_) {
+      if (word != 0) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool contains(Enum key) const noexcept {
+    auto i = Traits::indexOf(key);
+    return i && ((words_[*i / kWordBits] >> (*i % kWordBits)) & 1) != 0;
+  }
+
+  void insert(Enum key) noexcept {
+    auto i = *Traits::indexOf(key);
+    words_[i / kWordBits] |= Word{1} << (i % kWordBits);
+  }
+
+  void erase(Enum key) noexcept {
+    if (auto i = Traits::indexOf(key)) {
+      words_[*i / kWordBits] &= ~(Word{1} << (*i % kWordBits));
+    }
+  }
+
+  void clear() noexcept {
+    words_ = {};
+  }
+
+  Iterator begin() const {
+    return Iterator(this, 0);
+  }
+
+  Iterator end() const {
+    return Iterator();
+  }
+
+  EnumSet& operator|=(const EnumSet& other) noexcept {
+    for (std::size_t i = 0; i < kWords; ++i) {
+      words_[i] |= other.words_[i];
+    }
+    return *this;
+  }
+
+  EnumSet& operator&=(const EnumSet& other) noexcept {
+    for (std::size_t i = 0; i < kWords; ++i) {
+      words_[i] &= other.words_[i];
+    }
+    return *this;
+  }
+
+  friend EnumSet operator|(EnumSet lhs, const EnumSet& rhs) noexcept {
+    return lhs |= rhs;
+  }
+
+  friend EnumSet operator&(EnumSet lhs, const EnumSet& rhs) noexcept {
+    return lhs &= rhs;
+  }
+
+  bool operator==(const EnumSet& other) const = default;
+
+ private:
+  std::array<Word, kWords> words_{};
+};
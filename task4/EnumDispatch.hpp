@@ -0,0 +1,59 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include <EnumeratorTraits.hpp>
+
+namespace detail {
+
+template <class Enum, class Traits, class F>
+using DispatchResult =
+    decltype(std::declval<F&>().template operator()<Traits::at(0)>());
+
+// One instantiation of `f.operator()<e>` per enumerator, indexed by the
+// ordinal of the enumerator.
+template <class Enum, class Traits, class F, std::size_t... is>
+constexpr auto makeDispatchTable(std::index_sequence<is...>) {
+  using R = DispatchResult<Enum, Traits, F>;
+
+  return std::array<R (*)(F&), sizeof...(is)>{
+      +[](F& f) -> R { return f.template operator()<Traits::at(is)>(); }...};
+}
+
+template <class Enum, class Traits, class F>
+inline constexpr auto kDispatchTable = makeDispatchTable<Enum, Traits, F>(
+    std::make_index_sequence<Traits::size()>{});
+
+}  // namespace detail
+
+// Calls `f.template operator()<value>()` with the runtime `value` turned
+// into a template argument: the enumerator's ordinal is found through
+// Traits::indexOf (a subtraction or table load for compact enums, a binary
+// search for sparse ones) and used to index a table of instantiations.
+// Returns the result as std::optional, or whether `f` was called if it
+// returns void; nothing is called if `value` is not an enumerator.
+template <class Enum, class Traits = EnumeratorTraits<Enum>, class F>
+  requires std::is_enum_v<Enum> && (Traits::size() > 0)
+constexpr auto EnumDispatch(Enum value, F&& f) {
+  using Functor = std::remove_reference_t<F>;
+  using R = detail::DispatchResult<Enum, Traits, Functor>;
+
+  auto i = Traits::indexOf(value);
+
+  if constexpr (std::is_void_v<R>) {
+    if (i) {
+      detail::kDispatchTable<Enum, Traits, Functor>[*i](f);
+    }
+    return i.has_value();
+  } else {
+    std::optional<R> result;
+    if (i) {
+      result.emplace(detail::kDispatchTable<Enum, Traits, Functor>[*i](f));
+    }
+    return result;
+  }
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <cstddef>
+#include <limits>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <type_traits>
+
+#include <EnumeratorTraits.hpp>
+
+// Formatting and parsing of bit-flag enums as "Read|Write|Exec". Only
+// enumerators with a single bit set take part, plus an optional zero
+// enumerator; nothing here allocates.
+
+namespace detail {
+
+template <class Enum, class Traits>
+struct FlagNames {
+  using U = std::make_unsigned_t<std::underlying_type_t<Enum>>;
+
+  static constexpr std::size_t kBits = std::numeric_limits<U>::digits;
+  static constexpr std::size_t kNone = Traits::size();
+
+  // Enumerator index of every single-bit value, kNone where there is none.
+  static constexpr auto bit_index = [] {
+    std::array<std::size_t, kBits> result{};
+    result.fill(kNone);
+    for (std::size_t i = 0; i < Traits::size(); ++i) {
+      auto bits = static_cast<U>(Traits::at(i));
+      if (std::has_single_bit(bits)) {
+        result[std::countr_zero(bits)] = i;
+      }
+    }
+    return result;
+  }();
+
+  static constexpr std::optional<std::size_t> zero_index =
+      Traits::indexOf(static_cast<Enum>(0));
+};
+
+constexpr std::string_view trimSpaces(std::string_view s) {
+  while (!s.empty() && s.front() == ' ') {
+    s.remove_prefix(1);
+  }
+  while (!s.empty() && s.back() == ' ') {
+    s.remove_suffix(1);
+  }
+  return s;
+}
+
+}  // namespace detail
+
+// Writes the names of the bits set in `value`, joined by '|', into `buffer`.
+// Bits without an enumerator are written as one hexadecimal term, e.g.
+// "Read|0x30". Returns a view of the written text, or std::nullopt if it
+// does not fit.
+template <class Enum,
+          class Traits = ProbedEnumeratorTraits<Enum, ProbeBitFlags>>
+  requires std::is_enum_v<Enum>
+std::optional<std::string_view> formatFlags(Enum value,
+                                            std::span<char> buffer) {
+  using Names = detail::FlagNames<Enum, Traits>;
+  using U = typename Names::U;
+
+  std::size_t size = 0;
+  auto append = [&](std::string_view text) {
+    if (text.size() > buffer.size() - size) {
+      return false;
+    }
+    std::copy(text.begin(), text.end(), buffer.begin() + size);
+    size += text.size();
+    return true;
+  };
+
+  auto bits = static_cast<U>(value);
+  U unknown = 0;
+
+  if (bits == 0) {
+    if (!append(Names::zero_index ? Traits::nameAt(*Names::zero_index)
+                                  : "0")) {
+      return std::nullopt;
+    }
+  }
+
+  for (; bits != 0; bits &= bits - 1) {
+    auto bit = std::countr_zero(bits);
+    auto i = Names::bit_index[bit];
+
+    if (i == Names::kNone) {
+      unknown |= U{1} << bit;
+    } else if ((size != 0 && !append("|")) || !append(Traits::nameAt(i))) {
+      return std::nullopt;
+    }
+  }
+
+  if (unknown != 0) {
+    std::array<char, 2 + Names::kBits / 4> hex = {'0', 'x'};
+    auto [end, ec] =
+        std::to_chars(hex.data() + 2, hex.data() + hex.size(), unknown, 16);
+
+    if ((size != 0 && !append("|")) ||
+        !append({hex.data(), static_cast<std::size_t>(end - hex.data())})) {
+      return std::nullopt;
+    }
+  }
+
+  return std::string_view(buffer.data(), size);
+}
+
+// Parses "A|B|C" (spaces around names are allowed) as the bitwise or of the
+// named enumerators. Hexadecimal terms as written by formatFlags and "0" are
+// accepted too. Returns std::nullopt on an unknown or empty term.
+template <class Enum,
+          class Traits = ProbedEnumeratorTraits<Enum, ProbeBitFlags>>
+  requires std::is_enum_v<Enum>
+std::optional<Enum> parseFlags(std::string_view text) {
+  using U = typename detail::FlagNames<Enum, Traits>::U;
+
+  U bits = 0;
+
+  while (true) {
+    auto end = std::min(text.find('|'), text.size());
+    auto term = detail::trimSpaces(text.substr(0, end));
+
+    if (auto e = Traits::fromName(term)) {
+      bits |= static_cast<U>(*e);
+    } else if (term.size() > 2 && term[0] == '0' && term[1] == 'x') {
+      U term_bits = 0;
+      auto [ptr, ec] =
+          std::from_chars(term.data() + 2, term.data() + term.size(),
+                          term_bits, 16);
+      if (ec != std::errc() || ptr != term.data() + term.size()) {
+        return std::nullopt;
+      }
+      bits |= term_bits;
+    } else if (term != "0") {
+      return std::nullopt;
+    }
+
+    if (end == text.size()) {
+      return static_cast<Enum>(bits);
+    }
+
+    text.remove_prefix(end + 1);
+  }
+}
@@ -1,10 +1,16 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
+#include <bit>
+#include <concepts>
 #include <type_traits>
 #include <cstdint>
+#include <ranges>
 #include <string_view>
 #include <limits>
+#include <optional>
+#include <utility>
 
 namespace detail {
 template <auto T>
@@ -12,185 +18,473 @@ constexpr auto helper() {
   return __PRETTY_FUNCTION__;
 }
 
+// Clang prints "[T = Enum::kName]" and GCC "[with auto T = Enum::kName]";
+// values that are not enumerators come out as "(Enum)42".
 constexpr std::string_view extractT(const std::string_view& s) {
-  auto result = s.substr(s.find("[T = ") + sizeof("[T = ") - 1);
+  auto result = s.substr(s.rfind("T = ") + sizeof("T = ") - 1);
   result.remove_suffix(1);
 
-  if (auto pos = result.find("::"); pos != std::string_view::npos) {
+  if (result.find("(") != std::string_view::npos) {
+    return {};
+  } else if (auto pos = result.rfind("::"); pos != std::string_view::npos) {
     return result.substr(pos + sizeof("::") - 1);
-  } else if (result.find("(") == std::string_view::npos) {
-    return result;
   } else {
-    return {};
+    return result;
   }
 }
 
-template <class Enum, int e, int MAXN>
+// Name of a single candidate, evaluated as its own constant so that the
+// cost of an evaluation does not grow with the number of candidates.
+template <class Enum, std::underlying_type_t<Enum> value>
+inline constexpr std::string_view kNameOf =
+    extractT(helper<static_cast<Enum>(value)>());
+
+// Probes every candidate with a single pack expansion: one helper<>
+// instantiation per candidate and no recursion, so the template depth stays
+// constant whatever the number of candidates is.
+template <class Enum, class Candidates, std::size_t... is>
+constexpr auto probeNames(std::index_sequence<is...>) {
+  return std::array<std::string_view, sizeof...(is)>{
+      kNameOf<Enum, Candidates::values[is]>...};
+}
+
+// `Candidates::values` is an ascending array of underlying values.
+template <class Enum, class Candidates>
   requires std::is_enum_v<Enum>
-struct countEnumerators {
-  static constexpr std::string_view name =
-      extractT(helper<static_cast<Enum>(e)>());
-  static constexpr auto next = countEnumerators<Enum, e + 1, MAXN>::name.empty()
-                                   ? countEnumerators<Enum, e + 1, MAXN>::next
-                                   : e + 1;
-  static constexpr auto T = name.empty() ? 0 : 1;
-  static constexpr auto value = T + countEnumerators<Enum, e + 1, MAXN>::value;
+struct EnumeratorScan {
+  static constexpr auto names = probeNames<Enum, Candidates>(
+      std::make_index_sequence<Candidates::values.size()>{});
 
-  static constexpr std::pair<Enum, std::string_view> getAt(
-      std::size_t& i) noexcept {
-    using Next = countEnumerators<Enum, next, MAXN>;
+  static constexpr std::size_t size =
+      std::count_if(names.begin(), names.end(),
+                    [](std::string_view name) { return !name.empty(); });
 
-    if (name.empty()) {
-      return Next::getAt(i);
-    } else {
-      if (i == 0) {
-        return {static_cast<Enum>(e), name};
-      } else if (i == 1) {
-        --i;
-        return {static_cast<Enum>(next), Next::name};
-      } else {
-        constexpr auto next_next = Next::next;
-
-        if (next == MAXN || next_next == MAXN) {
-          return Next::getAt(--i);
-        } else {
-          i -= 2;
-          return countEnumerators<Enum, next_next, MAXN>::getAt(i);
-        }
+  // Enumerators in ascending order of value.
+  static constexpr auto enumerators = [] {
+    std::array<std::pair<Enum, std::string_view>, size> result{};
+
+    for (std::size_t i = 0, j = 0; j < names.size(); ++j) {
+      if (!names[j].empty()) {
+        result[i++] = {static_cast<Enum>(Candidates::values[j]), names[j]};
       }
     }
-  }
+
+    return result;
+  }();
 };
 
-template <class Enum, int MAXN>
-  requires std::is_enum_v<Enum>
-struct countEnumerators<Enum, MAXN, MAXN> {
-  static constexpr std::string_view name =
-      extractT(helper<static_cast<Enum>(MAXN)>());
-  static constexpr auto next = MAXN;
-  static constexpr auto value = name.empty() ? 0 : 1;
+// Runtime tables built from `Scan::enumerators` (sorted by value): values,
+// names packed into one blob with offsets, and a value -> index lookup that
+// is a subtraction for contiguous values, a dense array when the values are
+// compact and a binary search otherwise.
+template <class Enum, class Scan>
+struct EnumeratorTables {
+  using T = std::underlying_type_t<Enum>;
+  using Index =
+      std::conditional_t<Scan::size < 0xFFFF, std::uint16_t, std::uint32_t>;
 
-  static constexpr std::pair<Enum, std::string_view> getAt(
-      std::size_t& i) noexcept {
-    if (i == 0) {
-      return {static_cast<Enum>(MAXN), name};
-    } else {
-      if (!name.empty()) {
-        --i;
-      }
+  static constexpr std::size_t size = Scan::size;
 
-      if (i == 0) {
-        return {static_cast<Enum>(MAXN), ""};
+  static constexpr std::array<Enum, size> values = [] {
+    std::array<Enum, size> result{};
+    for (std::size_t i = 0; i < size; ++i) {
+      result[i] = Scan::enumerators[i].first;
+    }
+    return result;
+  }();
+
+  static constexpr std::size_t blob_size = [] {
+    std::size_t result = 0;
+    for (const auto& enumerator : Scan::enumerators) {
+      result += enumerator.second.size();
+    }
+    return result;
+  }();
+
+  static constexpr std::array<char, blob_size> names = [] {
+    std::array<char, blob_size> result{};
+    std::size_t offset = 0;
+    for (const auto& enumerator : Scan::enumerators) {
+      for (char c : enumerator.second) {
+        result[offset++] = c;
       }
+    }
+    return result;
+  }();
 
-      return {static_cast<Enum>(MAXN), name};
+  static constexpr std::array<std::uint32_t, size + 1> offsets = [] {
+    std::array<std::uint32_t, size + 1> result{};
+    for (std::size_t i = 0; i < size; ++i) {
+      result[i + 1] = result[i] + Scan::enumerators[i].second.size();
+    }
+    return result;
+  }();
+
+  // Distance from the smallest value, well-defined for any underlying type.
+  static constexpr std::uintmax_t ordinal(Enum e) noexcept {
+    if constexpr (size == 0) {
+      return 0;
+    } else {
+      return static_cast<std::uintmax_t>(static_cast<T>(e)) -
+             static_cast<std::uintmax_t>(static_cast<T>(values[0]));
     }
   }
-};
 
-}  // namespace detail
+  static constexpr std::uintmax_t max_ordinal =
+      size == 0 ? 0 : ordinal(values[size - 1]);
+  static constexpr bool is_contiguous = max_ordinal + 1 == size;
+  static constexpr bool is_dense =
+      !is_contiguous && max_ordinal < 4 * size + 64;
 
-template <class Enum, std::size_t MAXN = 512>
-  requires std::is_enum_v<Enum>
-struct EnumeratorTraits {
-  using T = std::underlying_type_t<Enum>;
-  static constexpr auto UND_MAX = std::numeric_limits<T>::max();
-  static constexpr auto UND_MIN = std::numeric_limits<T>::min();
+  static constexpr auto dense_index = [] {
+    std::array<Index, is_dense ? max_ordinal + 1 : 0> result{};
+    if constexpr (is_dense) {
+      std::fill(result.begin(), result.end(), static_cast<Index>(size));
+      for (std::size_t i = 0; i < size; ++i) {
+        result[ordinal(values[i])] = static_cast<Index>(i);
+      }
+    }
+    return result;
+  }();
 
-  // TODO: better
-  static constexpr std::size_t size() noexcept {
-    if constexpr (UND_MIN == 0) {
-      if constexpr (MAXN <= UND_MAX) {
-        return detail::countEnumerators<Enum, 0, MAXN>::value;
-      } else {
-        return detail::countEnumerators<Enum, 0, UND_MAX>::value;
+  static constexpr std::string_view nameAt(std::size_t i) noexcept {
+    return {names.data() + offsets[i], offsets[i + 1] - offsets[i]};
+  }
+
+  static constexpr std::optional<std::size_t> indexOf(Enum e) noexcept {
+    if constexpr (is_contiguous) {
+      if (auto offset = ordinal(e); offset < size) {
+        return offset;
+      }
+    } else if constexpr (is_dense) {
+      auto offset = ordinal(e);
+      if (offset < dense_index.size() && dense_index[offset] != size) {
+        return dense_index[offset];
       }
     } else {
-      if constexpr (MAXN <= UND_MAX) {
-        constexpr auto pos_cnt = detail::countEnumerators<Enum, 0, MAXN>::value;
-
-        if constexpr (UND_MIN >= -static_cast<int>(MAXN)) {
-          return pos_cnt + detail::countEnumerators<Enum, UND_MIN, -1>::value;
-        } else {
-          return pos_cnt +
-                 detail::countEnumerators<Enum, -static_cast<int>(MAXN),
-                                          -1>::value;
-        }
-      } else {
-        constexpr auto pos_cnt =
-            detail::countEnumerators<Enum, 0, UND_MAX>::value;
-
-        if constexpr (UND_MIN >= -static_cast<int>(MAXN)) {
-          return pos_cnt + detail::countEnumerators<Enum, UND_MIN, -1>::value;
-        } else {
-          return pos_cnt +
-                 detail::countEnumerators<Enum, -static_cast<int>(MAXN),
-                                          -1>::value;
-        }
+      auto it = std::lower_bound(values.begin(), values.end(), e,
+                                 [](Enum lhs, Enum rhs) {
+                                   return static_cast<T>(lhs) <
+                                          static_cast<T>(rhs);
+                                 });
+      if (it != values.end() && *it == e) {
+        return it - values.begin();
       }
     }
+
+    return std::nullopt;
   }
+};
 
-  static constexpr std::pair<Enum, std::string_view> getAt(
-      std::size_t i) noexcept {
-    if constexpr (UND_MIN == 0) {
-      if constexpr (MAXN <= UND_MAX) {
-        return detail::countEnumerators<Enum, 0, MAXN>::getAt(i);
-      } else {
-        return detail::countEnumerators<Enum, 0, UND_MAX>::getAt(i);
-      }
-    } else {
-      if constexpr (MAXN <= UND_MAX) {
-        if constexpr (UND_MIN >= -static_cast<int>(MAXN)) {
-          auto [e, name] =
-              detail::countEnumerators<Enum, UND_MIN, -1>::getAt(i);
-
-          if ((name.empty() && i == 0) || i > 0) {
-            return detail::countEnumerators<Enum, 0, MAXN>::getAt(i);
-          } else {
-            return {e, name};
-          }
-        } else {
-          auto [e, name] =
-              detail::countEnumerators<Enum, -static_cast<int>(MAXN),
-                                       -1>::getAt(i);
-
-          if ((name.empty() && i == 0) || i > 0) {
-            return detail::countEnumerators<Enum, 0, MAXN>::getAt(i);
-          } else {
-            return {e, name};
-          }
+constexpr std::uint64_t hashName(std::string_view name) noexcept {
+  std::uint64_t hash = 0xcbf29ce484222325ull;
+  for (char c : name) {
+    hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001b3ull;
+  }
+  return hash;
+}
+
+constexpr std::uint32_t mixHash(std::uint32_t x) noexcept {
+  x ^= x >> 16;
+  x *= 0x7feb352du;
+  x ^= x >> 15;
+  return x;
+}
+
+// Perfect hash of the enumerator names, built with hash-and-displace: the
+// low bits of a name's hash pick a bucket, and every bucket has a seed,
+// found at compile time, that sends its names to free slots. A lookup is
+// one hash of the input and one comparison with the name in its slot.
+template <class Tables>
+struct EnumeratorNameHash {
+  using Index = typename Tables::Index;
+
+  static constexpr std::size_t size = Tables::size;
+  static constexpr std::size_t slot_count = std::bit_ceil(size) * 2;
+  static constexpr std::size_t bucket_count =
+      slot_count >= 8 ? slot_count / 4 : 1;
+
+  static constexpr std::size_t bucketOf(std::uint64_t hash) noexcept {
+    return hash & (bucket_count - 1);
+  }
+
+  static constexpr std::size_t slotOf(std::uint64_t hash,
+                                      std::uint32_t seed) noexcept {
+    return mixHash(static_cast<std::uint32_t>(hash >> 32) ^ seed) &
+           (slot_count - 1);
+  }
+
+  struct Layout {
+    std::array<std::uint32_t, bucket_count> seeds{};
+    std::array<Index, slot_count> slots{};
+  };
+
+  static constexpr Layout layout = [] {
+    Layout result;
+    std::array<std::uint64_t, size> hashes{};
+    std::array<std::size_t, bucket_count + 1> bucket_begin{};
+    std::array<std::size_t, size> members{};
+
+    result.slots.fill(static_cast<Index>(size));
+
+    // Counting sort of the names by bucket.
+    for (std::size_t i = 0; i < size; ++i) {
+      hashes[i] = hashName(Tables::nameAt(i));
+      ++bucket_begin[bucketOf(hashes[i]) + 1];
+    }
+    for (std::size_t bucket = 0; bucket < bucket_count; ++bucket) {
+      bucket_begin[bucket + 1] += bucket_begin[bucket];
+    }
+    auto bucket_end = bucket_begin;
+    for (std::size_t i = 0; i < size; ++i) {
+      members[bucket_end[bucketOf(hashes[i])]++] = i;
+    }
+
+    std::size_t max_bucket_size = 0;
+    for (std::size_t bucket = 0; bucket < bucket_count; ++bucket) {
+      max_bucket_size = std::max(
+          max_bucket_size, bucket_begin[bucket + 1] - bucket_begin[bucket]);
+    }
+
+    // Largest buckets first, while most slots are still free.
+    for (std::size_t bucket_size = max_bucket_size; bucket_size > 0;
+         --bucket_size) {
+      for (std::size_t bucket = 0; bucket < bucket_count; ++bucket) {
+        auto begin = bucket_begin[bucket];
+        auto end = bucket_begin[bucket + 1];
+
+        if (end - begin != bucket_size) {
+          continue;
         }
-      } else {
-        if constexpr (UND_MIN >= -static_cast<int>(MAXN)) {
-          auto [e, name] =
-              detail::countEnumerators<Enum, UND_MIN, -1>::getAt(i);
-
-          if ((name.empty() && i == 0) || i > 0) {
-            return detail::countEnumerators<Enum, 0, UND_MAX>::getAt(i);
-          } else {
-            return {e, name};
+
+        for (std::uint32_t seed = 0;; ++seed) {
+          bool placed = true;
+
+          for (auto i = begin; i < end && placed; ++i) {
+            auto slot = slotOf(hashes[members[i]], seed);
+            placed = result.slots[slot] == size;
+
+            for (auto j = begin; j < i && placed; ++j) {
+              placed = slot != slotOf(hashes[members[j]], seed);
+            }
           }
-        } else {
-          auto [e, name] =
-              detail::countEnumerators<Enum, -static_cast<int>(MAXN),
-                                       -1>::getAt(i);
-
-          if ((name.empty() && i == 0) || i > 0) {
-            return detail::countEnumerators<Enum, 0, UND_MAX>::getAt(i);
-          } else {
-            return {e, name};
+
+          if (placed) {
+            for (auto i = begin; i < end; ++i) {
+              result.slots[slotOf(hashes[members[i]], seed)] =
+                  static_cast<Index>(members[i]);
+            }
+            result.seeds[bucket] = seed;
+            break;
           }
         }
       }
     }
+
+    return result;
+  }();
+
+  static constexpr std::optional<std::size_t> find(
+      std::string_view name) noexcept {
+    if constexpr (size == 0) {
+      return std::nullopt;
+    } else {
+      auto hash = hashName(name);
+      std::size_t i =
+          layout.slots[slotOf(hash, layout.seeds[bucketOf(hash)])];
+
+      if (i != size && Tables::nameAt(i) == name) {
+        return i;
+      }
+
+      return std::nullopt;
+    }
+  }
+};
+
+template <class Range>
+concept RangeOfNames =
+    std::ranges::input_range<Range> &&
+    std::convertible_to<std::ranges::range_reference_t<Range>,
+                        std::string_view>;
+
+// Merges the ascending candidate lists of every probe into one ascending
+// list without duplicates.
+template <class Enum, class... Probes>
+struct ProbeCandidates {
+  using T = std::underlying_type_t<Enum>;
+
+  static constexpr std::size_t total =
+      (std::size_t{0} + ... + Probes::template candidates<T>().size());
+
+  static constexpr auto merged = [] {
+    std::array<T, total> result{};
+    std::size_t size = 0;
+
+    auto merge = [&](const auto& candidates) {
+      std::array<T, total> previous = result;
+      std::size_t i = 0;
+      std::size_t j = 0;
+      std::size_t previous_size = std::exchange(size, 0);
+
+      while (i < previous_size || j < candidates.size()) {
+        T next = j == candidates.size() ||
+                         (i < previous_size && previous[i] < candidates[j])
+                     ? previous[i++]
+                     : candidates[j++];
+
+        if (size == 0 || result[size - 1] != next) {
+          result[size++] = next;
+        }
+      }
+    };
+
+    (merge(Probes::template candidates<T>()), ...);
+    return std::pair{result, size};
+  }();
+
+  static constexpr auto values = [] {
+    std::array<T, merged.second> result{};
+    std::copy_n(merged.first.begin(), merged.second, result.begin());
+    return result;
+  }();
+};
+
+template <class Enum, class... Probes>
+  requires std::is_enum_v<Enum>
+struct EnumeratorTraitsImpl {
+ private:
+  using Tables = EnumeratorTables<
+      Enum, EnumeratorScan<Enum, ProbeCandidates<Enum, Probes...>>>;
+
+ public:
+  static constexpr std::size_t size() noexcept {
+    return Tables::size;
+  }
+
+  static constexpr std::pair<Enum, std::string_view> getAt(
+      std::size_t i) noexcept {
+    return {at(i), nameAt(i)};
   }
 
   static constexpr Enum at(std::size_t i) noexcept {
-    return getAt(i).first;
+    return Tables::values[i];
   }
 
   static constexpr std::string_view nameAt(std::size_t i) noexcept {
-    return getAt(i).second;
+    return Tables::nameAt(i);
   }
+
+  // Position of `e` among the enumerators, if it is one.
+  static constexpr std::optional<std::size_t> indexOf(Enum e) noexcept {
+    return Tables::indexOf(e);
+  }
+
+  static constexpr std::optional<Enum> fromName(
+      std::string_view name) noexcept {
+    if (auto i = EnumeratorNameHash<Tables>::find(name)) {
+      return at(*i);
+    }
+
+    return std::nullopt;
+  }
+
+  // Parses a column of names: `out[i]` receives fromName of the i-th name,
+  // so `out` may be a Slice, std::span or sized container. Returns the
+  // number of names that are not enumerators.
+  template <RangeOfNames Range, class Out>
+    requires requires(Out out, std::size_t i, std::optional<Enum> e) {
+      out[i] = e;
+    }
+  static std::size_t fromNames(Range&& names, Out&& out) {
+    std::size_t i = 0;
+    std::size_t unknown = 0;
+
+    for (std::string_view name : names) {
+      auto e = fromName(name);
+      unknown += !e.has_value();
+      out[i++] = e;
+    }
+
+    return unknown;
+  }
+};
+
+}  // namespace detail
+
+// Probes. Each one lists the candidate values, in ascending order, that are
+// checked for being enumerators, so their number is the number of
+// instantiations paid per enum.
+
+// Every value in [min, max] representable in the underlying type.
+template <std::intmax_t min, std::intmax_t max>
+  requires(min <= max)
+struct ProbeRange {
+  template <class T>
+  static constexpr auto candidates() {
+    constexpr std::intmax_t lo = std::max<std::intmax_t>(
+        min, std::is_signed_v<T> ? std::intmax_t{std::numeric_limits<T>::min()}
+                                 : 0);
+    constexpr std::intmax_t hi = static_cast<std::intmax_t>(
+        std::min<std::uintmax_t>(std::numeric_limits<T>::max(),
+                                 max < 0 ? 0 : max));
+
+    if constexpr (lo > hi || (max < 0 && !std::is_signed_v<T>)) {
+      return std::array<T, 0>{};
+    } else {
+      std::array<T, hi - lo + 1> result{};
+      for (std::size_t i = 0; i < result.size(); ++i) {
+        result[i] = static_cast<T>(lo + static_cast<std::intmax_t>(i));
+      }
+      return result;
+    }
+  }
+};
+
+// Zero and every single-bit value of the underlying type: all enumerators of
+// a bit-flag enum with one instantiation per bit.
+struct ProbeBitFlags {
+  template <class T>
+  static constexpr auto candidates() {
+    using U = std::make_unsigned_t<T>;
+    constexpr std::size_t bits = std::numeric_limits<U>::digits;
+
+    std::array<T, bits + 1> result{};
+    for (std::size_t i = 0; i < bits; ++i) {
+      result[i + 1] = static_cast<T>(U{1} << i);
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+  }
+};
+
+// Explicitly listed values, e.g. known error codes.
+template <auto... vs>
+struct ProbeValues {
+  template <class T>
+  static constexpr auto candidates() {
+    std::array<T, sizeof...(vs)> result{static_cast<T>(vs)...};
+    std::sort(result.begin(), result.end());
+    return result;
+  }
+};
+
+// EnumeratorTraits for enums whose values do not fit into a small range
+// around zero: only the candidates of `Probes...` are checked, e.g.
+// `ProbedEnumeratorTraits<Flags, ProbeBitFlags>` or
+// `ProbedEnumeratorTraits<Error, ProbeRange<0, 64>, ProbeValues<1 << 20>>`.
+template <class Enum, class... Probes>
+  requires std::is_enum_v<Enum>
+struct ProbedEnumeratorTraits : detail::EnumeratorTraitsImpl<Enum, Probes...> {
+};
+
+template <class Enum, std::size_t MAXN = 512>
+  requires std::is_enum_v<Enum>
+struct EnumeratorTraits
+    : detail::EnumeratorTraitsImpl<
+          Enum, ProbeRange<-static_cast<std::intmax_t>(MAXN),
+                           static_cast<std::intmax_t>(MAXN)>> {
+  using T = std::underlying_type_t<Enum>;
+  static constexpr auto UND_MAX = std::numeric_limits<T>::max();
+  static constexpr auto UND_MIN = std::numeric_limits<T>::min();
 };
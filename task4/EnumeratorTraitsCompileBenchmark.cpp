@@ -0,0 +1,42 @@
+// Compile-time benchmark for EnumeratorTraits: instantiates the traits for
+// enums of 16, 64 and 512 enumerators, a sparse and a bit-flag one. Compare
+// builds with different probe ranges, e.g.
+//   time clang++ -std=c++20 -fsyntax-only -I. -DBENCH_MAXN=512 <this file>
+// and add -ftime-trace for a per-instantiation breakdown.
+
+#include <cstdint>
+
+#include <EnumeratorTraits.hpp>
+
+#ifndef BENCH_MAXN
+#define BENCH_MAXN 512
+#endif
+
+#define ENUMERATORS_8(p) p##0, p##1, p##2, p##3, p##4, p##5, p##6, p##7
+#define ENUMERATORS_64(p)                                               \
+  ENUMERATORS_8(p##0), ENUMERATORS_8(p##1), ENUMERATORS_8(p##2),        \
+      ENUMERATORS_8(p##3), ENUMERATORS_8(p##4), ENUMERATORS_8(p##5),    \
+      ENUMERATORS_8(p##6), ENUMERATORS_8(p##7)
+#define ENUMERATORS_512(p)                                              \
+  ENUMERATORS_64(p##0), ENUMERATORS_64(p##1), ENUMERATORS_64(p##2),     \
+      ENUMERATORS_64(p##3), ENUMERATORS_64(p##4), ENUMERATORS_64(p##5), \
+      ENUMERATORS_64(p##6), ENUMERATORS_64(p##7)
+
+enum class Enum16 { ENUMERATORS_8(A), ENUMERATORS_8(B) };
+enum class Enum64 { ENUMERATORS_64(A) };
+enum class Enum512 { ENUMERATORS_512(A) };
+enum class Sparse { A = -400, B = -3, C = 0, D = 100, E = 511 };
+enum class Flags : std::uint64_t { A = 1, B = 1 << 10, C = 1ull << 40 };
+
+static constexpr std::size_t kMaxN = BENCH_MAXN;
+
+static_assert(EnumeratorTraits<Enum16, kMaxN>::size() == 16);
+static_assert(EnumeratorTraits<Enum64, kMaxN>::size() == 64);
+static_assert(EnumeratorTraits<Enum512, kMaxN>::size() ==
+              (kMaxN < 511 ? kMaxN + 1 : 512));
+static_assert(EnumeratorTraits<Sparse, kMaxN>::size() ==
+              (kMaxN >= 511 ? 5 : kMaxN >= 400 ? 4 : kMaxN >= 100 ? 3 : 2));
+static_assert(ProbedEnumeratorTraits<Flags, ProbeBitFlags>::size() == 3);
+
+int main() {
+}
@@ -0,0 +1,883 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <EnumeratorTraits.hpp>
+#include <reflect.hpp>
+
+// JSON for reflected aggregates, written straight into a std::string and
+// parsed in one pass into the target object without building a tree.
+//
+// Aggregates become objects, std::vector and std::array arrays and
+// std::optional null or its value. Field annotations:
+//   JsonName<"key">   the key of the field; Describe knows no field names,
+//                     so fields without one are keyed by their index
+//   JsonSkip          neither written nor read
+//   JsonInline        the fields of an aggregate field go into the enclosing
+//                     object; they all need a JsonName
+//   JsonEnumAsString  enums, also inside containers, are written by the
+//                     name EnumeratorTraits gives them; values without a
+//                     name are written as numbers
+//
+// Keys are written as is and must be unique within an object. Reading
+// ignores unknown keys, leaves fields that are not present as they are and
+// accepts both names and numbers for enums. std::string_view fields point
+// into the input and can only be read from strings without escapes.
+
+template <std::size_t n>
+struct JsonKeyLiteral {
+  constexpr JsonKeyLiteral(const char (&key)[n]) {
+    std::copy_n(key, n, chars);
+  }
+
+  char chars[n]{};
+};
+
+template <JsonKeyLiteral key>
+struct JsonName {};
+
+struct JsonSkip {};
+
+struct JsonInline {};
+
+struct JsonEnumAsString {};
+
+namespace detail {
+
+enum class JsonKind {
+  kUnsupported,
+  kBool,
+  kNumber,
+  kEnum,
+  kString,
+  kStringView,
+  kOptional,
+  kArray,
+  kObject,
+};
+
+template <class F>
+struct JsonKindOf {
+  static constexpr JsonKind kValue = [] {
+    if constexpr (std::is_same_v<F, bool>) {
+      return JsonKind::kBool;
+    } else if constexpr (std::is_arithmetic_v<F>) {
+      return JsonKind::kNumber;
+    } else if constexpr (std::is_enum_v<F>) {
+      return JsonKind::kEnum;
+    } else if constexpr (kReflectable<F>) {
+      return JsonKind::kObject;
+    } else {
+      return JsonKind::kUnsupported;
+    }
+  }();
+};
+
+template <class Traits, class Allocator>
+struct JsonKindOf<std::basic_string<char, Traits, Allocator>> {
+  static constexpr JsonKind kValue = JsonKind::kString;
+};
+
+template <>
+struct JsonKindOf<std::string_view> {
+  static constexpr JsonKind kValue = JsonKind::kStringView;
+};
+
+template <class U>
+struct JsonKindOf<std::optional<U>> {
+  static constexpr JsonKind kValue = JsonKind::kOptional;
+};
+
+template <class U, class Allocator>
+struct JsonKindOf<std::vector<U, Allocator>> {
+  static constexpr JsonKind kValue = JsonKind::kArray;
+};
+
+template <class U, std::size_t n>
+struct JsonKindOf<std::array<U, n>> {
+  static constexpr JsonKind kValue = JsonKind::kArray;
+};
+
+template <class F>
+constexpr JsonKind kJsonKind = JsonKindOf<F>::kValue;
+
+template <class A>
+struct JsonNameOf {
+  static constexpr std::optional<std::string_view> kKey = std::nullopt;
+};
+
+template <JsonKeyLiteral key>
+struct JsonNameOf<JsonName<key>> {
+  static constexpr std::optional<std::string_view> kKey =
+      std::string_view(key.chars, sizeof(key.chars) - 1);
+};
+
+template <std::size_t i>
+constexpr auto kIndexKey = [] {
+  std::array<char, std::numeric_limits<std::size_t>::digits10 + 1> digits{};
+  std::size_t size = 0;
+  for (auto rest = i; size == 0 || rest != 0; rest /= 10) {
+    digits[size++] = static_cast<char>('0' + rest % 10);
+  }
+  std::reverse(digits.begin(), digits.begin() + size);
+  return std::pair{digits, size};
+}();
+
+template <class T, std::size_t i>
+struct JsonField {
+  using Descriptor = typename Describe<T>::template Field<i>;
+  using Type = typename Descriptor::Type;
+
+  static constexpr bool kSkip =
+      Descriptor::template has_annotation_class<JsonSkip>;
+  static constexpr bool kInline =
+      Descriptor::template has_annotation_class<JsonInline>;
+  static constexpr bool kEnumAsString =
+      Descriptor::template has_annotation_class<JsonEnumAsString>;
+
+  static constexpr std::optional<std::string_view> kName =
+      []<class... As>(std::type_identity<Annotate<As...>>) {
+        std::optional<std::string_view> name;
+        ((name = name ? name : JsonNameOf<As>::kKey), ...);
+        return name;
+      }(std::type_identity<typename Descriptor::Annotations>{});
+
+  static constexpr std::string_view kKey = kName.value_or(
+      std::string_view(kIndexKey<i>.first.data(), kIndexKey<i>.second));
+};
+
+// Whether every key an object of F writes, those of inlined fields
+// included, comes from a JsonName.
+template <class F>
+constexpr bool kAllFieldsNamed =
+    []<std::size_t... is>(std::index_sequence<is...>) {
+      return ([] {
+        using Field = JsonField<F, is>;
+        if constexpr (Field::kSkip) {
+          return true;
+        } else if constexpr (Field::kInline) {
+          return kAllFieldsNamed<typename Field::Type>;
+        } else {
+          return Field::kName.has_value();
+        }
+      }() && ...);
+    }(std::make_index_sequence<Describe<F>::num_fields>{});
+
+// Index keys of inlined fields would collide with those of the enclosing
+// object, so inlined fields need names.
+template <class F>
+constexpr bool kInlinedFieldsNamed =
+    []<std::size_t... is>(std::index_sequence<is...>) {
+      return ([] {
+        using Field = JsonField<F, is>;
+        if constexpr (Field::kInline && !Field::kSkip) {
+          return kAllFieldsNamed<typename Field::Type>;
+        } else {
+          return true;
+        }
+      }() && ...);
+    }(std::make_index_sequence<Describe<F>::num_fields>{});
+
+template <class F>
+constexpr std::size_t kJsonKeyCount =
+    []<std::size_t... is>(std::index_sequence<is...>) {
+      return ([] {
+        using Field = JsonField<F, is>;
+        if constexpr (Field::kSkip) {
+          return std::size_t{0};
+        } else if constexpr (Field::kInline) {
+          return kJsonKeyCount<typename Field::Type>;
+        } else {
+          return std::size_t{1};
+        }
+      }() + ... + 0);
+    }(std::make_index_sequence<Describe<F>::num_fields>{});
+
+// The keys an object of F writes, those of inlined fields included.
+template <class F>
+constexpr auto kJsonKeys = [] {
+  std::array<std::string_view, kJsonKeyCount<F>> keys{};
+  std::size_t size = 0;
+
+  [&]<std::size_t... is>(std::index_sequence<is...>) {
+    ([&] {
+      using Field = JsonField<F, is>;
+      if constexpr (Field::kSkip) {
+        return;
+      } else if constexpr (Field::kInline) {
+        for (auto key : kJsonKeys<typename Field::Type>) {
+          keys[size++] = key;
+        }
+      } else {
+        keys[size++] = Field::kKey;
+      }
+    }(), ...);
+  }(std::make_index_sequence<Describe<F>::num_fields>{});
+  return keys;
+}();
+
+template <class F>
+constexpr bool kJsonKeysUnique = [] {
+  auto keys = kJsonKeys<F>;
+  std::sort(keys.begin(), keys.end());
+  return std::adjacent_find(keys.begin(), keys.end()) == keys.end();
+}();
+
+template <class F>
+constexpr bool kJsonEncodable = [] {
+  constexpr auto kind = kJsonKind<F>;
+
+  if constexpr (kind == JsonKind::kOptional || kind == JsonKind::kArray) {
+    return kJsonEncodable<typename F::value_type>;
+  } else if constexpr (kind == JsonKind::kObject) {
+    return []<std::size_t... is>(std::index_sequence<is...>) {
+      return ((JsonField<F, is>::kSkip ||
+               (kJsonEncodable<typename JsonField<F, is>::Type> &&
+                (!JsonField<F, is>::kInline ||
+                 kJsonKind<typename JsonField<F, is>::Type> ==
+                     JsonKind::kObject))) &&
+              ...);
+    }(std::make_index_sequence<Describe<F>::num_fields>{});
+  } else {
+    return kind != JsonKind::kUnsupported;
+  }
+}();
+
+inline void writeJsonString(std::string& out, std::string_view value) {
+  static constexpr char kHex[] = "0123456789abcdef";
+
+  out += '"';
+  std::size_t begin = 0;
+
+  for (std::size_t i = 0; i < value.size(); ++i) {
+    auto c = static_cast<unsigned char>(value[i]);
+    if (c >= 0x20 && c != '"' && c != '\\') {
+      continue;
+    }
+
+    out.append(value, begin, i - begin);
+    begin = i + 1;
+
+    switch (c) {
+      case '"':
+        out += "\\\"";
+        break;
+      case '\\':
+        out += "\\\\";
+        break;
+      case '\n':
+        out += "\\n";
+        break;
+      case '\r':
+        out += "\\r";
+        break;
+      case '\t':
+        out += "\\t";
+        break;
+      default:
+        out += "\\u00";
+        out += kHex[c >> 4];
+        out += kHex[c & 0xf];
+    }
+  }
+
+  out.append(value, begin);
+  out += '"';
+}
+
+template <class F>
+void writeJsonNumber(std::string& out, F value) {
+  if constexpr (std::is_floating_point_v<F>) {
+    if (!std::isfinite(value)) {
+      out += "null";
+      return;
+    }
+  }
+
+  char buffer[64];
+  auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+  out.append(buffer, end);
+}
+
+template <bool kEnumAsString, class F>
+void writeJsonValue(std::string& out, const F& value);
+
+template <class T>
+void writeJsonFields(std::string& out, const T& value, bool& first) {
+  [&]<std::size_t... is>(std::index_sequence<is...>) {
+    ([&] {
+      using Field = JsonField<T, is>;
+      const auto& field = Field::Descriptor::get(value);
+
+      if constexpr (Field::kSkip) {
+        return;
+      } else if constexpr (Field::kInline) {
+        writeJsonFields(out, field, first);
+      } else {
+        out += first ? "\"" : ",\"";
+        out += Field::kKey;
+        out += "\":";
+        writeJsonValue<Field::kEnumAsString>(out, field);
+        first = false;
+      }
+    }(), ...);
+  }(std::make_index_sequence<Describe<T>::num_fields>{});
+}
+
+template <bool kEnumAsString, class F>
+void writeJsonValue(std::string& out, const F& value) {
+  constexpr auto kind = kJsonKind<F>;
+
+  if constexpr (kind == JsonKind::kBool) {
+    out += value ? "true" : "false";
+  } else if constexpr (kind == JsonKind::kNumber) {
+    writeJsonNumber(out, value);
+  } else if constexpr (kind == JsonKind::kEnum) {
+    if constexpr (kEnumAsString) {
+      if (auto i = EnumeratorTraits<F>::indexOf(value)) {
+        writeJsonString(out, EnumeratorTraits<F>::nameAt(*i));
+        return;
+      }
+    }
+    writeJsonNumber(out, static_cast<std::underlying_type_t<F>>(value));
+  } else if constexpr (kind == JsonKind::kString ||
+                       kind == JsonKind::kStringView) {
+    writeJsonString(out, value);
+  } else if constexpr (kind == JsonKind::kOptional) {
+    if (value) {
+      writeJsonValue<kEnumAsString>(out, *value);
+    } else {
+      out += "null";
+    }
+  } else if constexpr (kind == JsonKind::kArray) {
+    out += '[';
+    bool first = true;
+    for (const auto& element : value) {
+      if (!std::exchange(first, false)) {
+        out += ',';
+      }
+      writeJsonValue<kEnumAsString>(out, element);
+    }
+    out += ']';
+  } else {
+    static_assert(kInlinedFieldsNamed<F>,
+                  "every field brought in by JsonInline needs a JsonName");
+    static_assert(kJsonKeysUnique<F>, "the keys of an object must be unique");
+
+    out += '{';
+    bool first = true;
+    writeJsonFields(out, value, first);
+    out += '}';
+  }
+}
+
+class JsonReader {
+ public:
+  explicit JsonReader(std::string_view in) noexcept : in_(in) {
+  }
+
+  // Skips whitespace and returns the next character, or '\0' at the end.
+  char peek() noexcept {
+    while (position_ < in_.size() &&
+           (in_[position_] == ' ' || in_[position_] == '\t' ||
+            in_[position_] == '\n' || in_[position_] == '\r')) {
+      ++position_;
+    }
+    return position_ < in_.size() ? in_[position_] : '\0';
+  }
+
+  bool consume(char c) noexcept {
+    if (peek() != c) {
+      return false;
+    }
+    ++position_;
+    return true;
+  }
+
+  bool consume(std::string_view word) noexcept {
+    peek();
+    if (in_.substr(position_, word.size()) != word) {
+      return false;
+    }
+    position_ += word.size();
+    return true;
+  }
+
+  bool atEnd() noexcept {
+    return peek() == '\0' && position_ == in_.size();
+  }
+
+  // The characters of a number literal, not validated.
+  std::string_view number() noexcept {
+    peek();
+    auto begin = position_;
+    while (position_ < in_.size() &&
+           std::string_view("+-.0123456789eE").find(in_[position_]) !=
+               std::string_view::npos) {
+      ++position_;
+    }
+    return in_.substr(begin, position_ - begin);
+  }
+
+  // Contents of a string without escapes, in place.
+  std::optional<std::string_view> rawString() noexcept {
+    if (!consume('"')) {
+      return std::nullopt;
+    }
+
+    auto end = in_.find_first_of("\"\\", position_);
+    if (end == std::string_view::npos || in_[end] != '"') {
+      return std::nullopt;
+    }
+
+    auto result = in_.substr(position_, end - position_);
+    position_ = end + 1;
+    return result;
+  }
+
+  // Contents of any string, in place if it has no escapes and unescaped
+  // into `scratch` otherwise.
+  std::optional<std::string_view> string(std::string& scratch) {
+    if (peek() != '"') {
+      return std::nullopt;
+    }
+
+    auto end = in_.find_first_of("\"\\", position_ + 1);
+    if (end != std::string_view::npos && in_[end] == '"') {
+      return rawString();
+    }
+
+    scratch.clear();
+    if (!unescape(scratch)) {
+      return std::nullopt;
+    }
+    return scratch;
+  }
+
+  // Skips one value of any kind. Nested brackets are only counted, so
+  // malformed input inside a skipped value may go unnoticed.
+  bool skipValue() {
+    std::size_t depth = 0;
+    std::string scratch;
+
+    do {
+      switch (peek()) {
+        case '"':
+          if (!string(scratch)) {
+            return false;
+          }
+          break;
+        case '{':
+        case '[':
+          ++position_;
+          ++depth;
+          break;
+        case '}':
+        case ']':
+          if (depth == 0) {
+            return false;
+          }
+          ++position_;
+          --depth;
+          break;
+        case ',':
+        case ':':
+          if (depth == 0) {
+            return false;
+          }
+          ++position_;
+          break;
+        case 't':
+          if (!consume("true")) {
+            return false;
+          }
+          break;
+        case 'f':
+          if (!consume("false")) {
+            return false;
+          }
+          break;
+        case 'n':
+          if (!consume("null")) {
+            return false;
+          }
+          break;
+        default:
+          if (number().empty()) {
+            return false;
+          }
+      }
+    } while (depth > 0);
+
+    return true;
+  }
+
+ private:
+  bool unescape(std::string& out) {
+    ++position_;
+
+    while (position_ < in_.size()) {
+      char c = in_[position_++];
+      if (c == '"') {
+        return true;
+      }
+      if (c != '\\') {
+        out += c;
+        continue;
+      }
+      if (position_ == in_.size()) {
+        return false;
+      }
+
+      switch (in_[position_++]) {
+        case '"':
+          out += '"';
+          break;
+        case '\\':
+          out += '\\';
+          break;
+        case '/':
+          out += '/';
+          break;
+        case 'b':
+          out += '\b';
+          break;
+        case 'f':
+          out += '\f';
+          break;
+        case 'n':
+          out += '\n';
+          break;
+        case 'r':
+          out += '\r';
+          break;
+        case 't':
+          out += '\t';
+          break;
+        case 'u':
+          if (!unescapeCodePoint(out)) {
+            return false;
+          }
+          break;
+        default:
+          return false;
+      }
+    }
+
+    return false;
+  }
+
+  std::optional<char32_t> hex4() noexcept {
+    if (in_.size() - position_ < 4) {
+      return std::nullopt;
+    }
+
+    std::uint16_t value;
+    auto begin = in_.data() + position_;
+    auto [end, ec] = std::from_chars(begin, begin + 4, value, 16);
+    if (ec != std::errc() || end != begin + 4) {
+      return std::nullopt;
+    }
+
+    position_ += 4;
+    return value;
+  }
+
+  // After "\u": a code point, possibly as a surrogate pair, as UTF-8.
+  bool unescapeCodePoint(std::string& out) {
+    auto code = hex4();
+    if (!code) {
+      return false;
+    }
+
+    if (*code >= 0xd800 && *code < 0xdc00) {
+      if (!consume("\\u")) {
+        return false;
+      }
+      auto low = hex4();
+      if (!low || *low < 0xdc00 || *low >= 0xe000) {
+        return false;
+      }
+      *code = 0x10000 + ((*code - 0xd800) << 10) + (*low - 0xdc00);
+    } else if (*code >= 0xdc00 && *code < 0xe000) {
+      return false;
+    }
+
+    auto put = [&](char32_t bits) { out += static_cast<char>(bits); };
+    if (*code < 0x80) {
+      put(*code);
+    } else if (*code < 0x800) {
+      put(0xc0 | (*code >> 6));
+      put(0x80 | (*code & 0x3f));
+    } else if (*code < 0x10000) {
+      put(0xe0 | (*code >> 12));
+      put(0x80 | ((*code >> 6) & 0x3f));
+      put(0x80 | (*code & 0x3f));
+    } else {
+      put(0xf0 | (*code >> 18));
+      put(0x80 | ((*code >> 12) & 0x3f));
+      put(0x80 | ((*code >> 6) & 0x3f));
+      put(0x80 | (*code & 0x3f));
+    }
+    return true;
+  }
+
+ private:
+  std::string_view in_;
+  std::size_t position_ = 0;
+};
+
+template <class F>
+bool readJsonNumber(JsonReader& in, F& value) {
+  if constexpr (std::is_floating_point_v<F>) {
+    if (in.consume("null")) {
+      value = std::numeric_limits<F>::quiet_NaN();
+      return true;
+    }
+  }
+
+  auto digits = in.number();
+  auto [end, ec] =
+      std::from_chars(digits.data(), digits.data() + digits.size(), value);
+  return !digits.empty() && ec == std::errc() &&
+         end == digits.data() + digits.size();
+}
+
+template <bool kEnumAsString, class F>
+bool readJsonValue(JsonReader& in, F& value);
+
+// Reads the value of `key` into the field it names, if there is one.
+template <class T>
+bool readJsonField(JsonReader& in, std::string_view key, T& value,
+                   bool& found) {
+  return [&]<std::size_t... is>(std::index_sequence<is...>) {
+    return ([&] {
+      using Field = JsonField<T, is>;
+
+      if constexpr (Field::kSkip) {
+        return true;
+      } else if constexpr (Field::kInline) {
+        return found ||
+               readJsonField(in, key, Field::Descriptor::get(value), found);
+      } else {
+        if (found || key != Field::kKey) {
+          return true;
+        }
+        found = true;
+        return readJsonValue<Field::kEnumAsString>(
+            in, Field::Descriptor::get(value));
+      }
+    }() && ...);
+  }(std::make_index_sequence<Describe<T>::num_fields>{});
+}
+
+template <bool kEnumAsString, class F>
+bool readJsonValue(JsonReader& in, F& value) {
+  constexpr auto kind = kJsonKind<F>;
+
+  if constexpr (kind == JsonKind::kBool) {
+    if (in.consume("true")) {
+      value = true;
+    } else if (in.consume("false")) {
+      value = false;
+    } else {
+      return false;
+    }
+    return true;
+  } else if constexpr (kind == JsonKind::kNumber) {
+    return readJsonNumber(in, value);
+  } else if constexpr (kind == JsonKind::kEnum) {
+    if (in.peek() == '"') {
+      std::string scratch;
+      auto name = in.string(scratch);
+      auto e = name ? EnumeratorTraits<F>::fromName(*name) : std::nullopt;
+      if (e) {
+        value = *e;
+      }
+      return e.has_value();
+    }
+
+    std::underlying_type_t<F> number;
+    if (!readJsonNumber(in, number)) {
+      return false;
+    }
+    value = static_cast<F>(number);
+    return true;
+  } else if constexpr (kind == JsonKind::kString) {
+    value.clear();
+    auto contents = in.string(value);
+    if (contents && contents->data() != value.data()) {
+      value = *contents;
+    }
+    return contents.has_value();
+  } else if constexpr (kind == JsonKind::kStringView) {
+    auto contents = in.rawString();
+    if (contents) {
+      value = *contents;
+    }
+    return contents.has_value();
+  } else if constexpr (kind == JsonKind::kOptional) {
+    if (in.consume("null")) {
+      value.reset();
+      return true;
+    }
+    return readJsonValue<kEnumAsString>(in, value.emplace());
+  } else if constexpr (kind == JsonKind::kArray) {
+    if (!in.consume('[')) {
+      return false;
+    }
+
+    constexpr bool kResizable =
+        requires { value.clear(), value.emplace_back(); };
+    if constexpr (kResizable) {
+      value.clear();
+    }
+
+    std::size_t size = 0;
+    if (in.consume(']')) {
+      return kResizable || size == value.size();
+    }
+
+    do {
+      if constexpr (kResizable) {
+        if (!readJsonValue<kEnumAsString>(in, value.emplace_back())) {
+          return false;
+        }
+      } else {
+        if (size == value.size() ||
+            !readJsonValue<kEnumAsString>(in, value[size])) {
+          return false;
+        }
+      }
+      ++size;
+    } while (in.consume(','));
+
+    return in.consume(']') && (kResizable || size == value.size());
+  } else {
+    static_assert(kInlinedFieldsNamed<F>,
+                  "every field brought in by JsonInline needs a JsonName");
+    static_assert(kJsonKeysUnique<F>, "the keys of an object must be unique");
+
+    if (!in.consume('{')) {
+      return false;
+    }
+    if (in.consume('}')) {
+      return true;
+    }
+
+    std::string scratch;
+    do {
+      auto key = in.string(scratch);
+      bool found = false;
+      if (!key || !in.consume(':') ||
+          !readJsonField(in, *key, value, found) ||
+          (!found && !in.skipValue())) {
+        return false;
+      }
+    } while (in.consume(','));
+
+    return in.consume('}');
+  }
+}
+
+}  // namespace detail
+
+template <class T>
+concept JsonSerializable = detail::kJsonEncodable<T>;
+
+// Appends `value` to `out`.
+template <JsonSerializable T>
+void writeJson(std::string& out, const T& value) {
+  detail::writeJsonValue<false>(out, value);
+}
+
+template <JsonSerializable T>
+std::string toJson(const T& value) {
+  std::string out;
+  writeJson(out, value);
+  return out;
+}
+
+// Parses `json`, which must hold exactly one value, into `value`. On failure
+// `value` may be partially updated.
+template <JsonSerializable T>
+bool readJson(std::string_view json, T& value) {
+  detail::JsonReader in(json);
+  return detail::readJsonValue<false>(in, value) && in.atEnd();
+}
+
+template <JsonSerializable T>
+  requires std::default_initializable<T>
+std::optional<T> fromJson(std::string_view json) {
+  std::optional<T> value(std::in_place);
+  if (!readJson(json, *value)) {
+    return std::nullopt;
+  }
+  return value;
+}
+
+// Writes a JSON array one element at a time, so that a large record set
+// never has to be held in memory at once.
+class JsonArrayWriter {
+ public:
+  explicit JsonArrayWriter(std::string& out) : out_(out) {
+    out_ += '[';
+  }
+
+  template <JsonSerializable T>
+  void write(const T& value) {
+    if (!std::exchange(first_, false)) {
+      out_ += ',';
+    }
+    writeJson(out_, value);
+  }
+
+  void finish() {
+    out_ += ']';
+  }
+
+ private:
+  std::string& out_;
+  bool first_ = true;
+};
+
+// Parses a JSON array element by element, passing each one to `f` as soon
+// as it is read. Returns false on malformed input, after `f` has seen the
+// elements before the error.
+template <JsonSerializable T, class F>
+  requires std::default_initializable<T> && std::invocable<F&, T&&>
+bool readJsonArray(std::string_view json, F&& f) {
+  detail::JsonReader in(json);
+  if (!in.consume('[')) {
+    return false;
+  }
+
+  if (!in.consume(']')) {
+    do {
+      T value{};
+      if (!detail::readJsonValue<false>(in, value)) {
+        return false;
+      }
+      f(std::move(value));
+    } while (in.consume(','));
+
+    if (!in.consume(']')) {
+      return false;
+    }
+  }
+
+  return in.atEnd();
+}
@@ -1,29 +1,610 @@
 #pragma once
 
-#include <cstdint>
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 
+// Fields of type Annotate<...> annotate the next non-annotation field of the
+// aggregate; several of them in a row add up:
+//
+//   struct S {
+//     Annotate<NoSerialize> a0;
+//     Annotate<Name<"x">> a1;
+//     int x;
+//   };
+//
+// gives Describe<S>::num_fields == 1 and Describe<S>::Field<0>::Annotations
+// == Annotate<NoSerialize, Name<"x">>.
+//
+// Reflected types are aggregates without base classes and with at most 128
+// fields, annotations included, none of which is an array, a reference or a
+// bit-field. The field count is found by a binary search over aggregate
+// initialization, and all field types and references to the fields come
+// from one structured binding with that many names, so the number of
+// instantiations does not grow with the number of fields.
 
 template <class...>
 class Annotate {};
 
-struct /* unspecified (field descriptor) */ {
-    using Type = /* ... */;
-    using Annotations = Annotate</* ... */>;
+namespace detail {
 
-    template <template <class...> class AnnotationTemplate>
-    static constexpr bool has_annotation_template = /* ... */;
-    
-    template <class Annotation>
-    static constexpr bool has_annotation_class = /* ... */;
+template <class T>
+struct IsAnnotate : std::false_type {};
+
+template <class... As>
+struct IsAnnotate<Annotate<As...>> : std::true_type {};
+
+template <class T, template <class...> class Template>
+struct IsSpecializationOf : std::false_type {};
+
+template <template <class...> class Template, class... Args>
+struct IsSpecializationOf<Template<Args...>, Template> : std::true_type {};
+
+// Converts to anything, for counting fields.
+struct AnyField {
+  template <class U>
+  operator U() const noexcept;
+};
+
+template <class T, std::size_t n>
+constexpr bool kInitializableWith =
+    []<std::size_t... is>(std::index_sequence<is...>) {
+      return requires { T{(static_cast<void>(is), AnyField{})...}; };
+    }(std::make_index_sequence<n>{});
+
+// Largest n in [lo, hi] such that T{AnyField x n} compiles. This is the
+// field count when every field can be left out of the initializer.
+template <class T, std::size_t lo, std::size_t hi>
+constexpr std::size_t searchFields() {
+  if constexpr (lo == hi) {
+    return lo;
+  } else {
+    constexpr std::size_t mid = lo + (hi - lo + 1) / 2;
+    if constexpr (kInitializableWith<T, mid>) {
+      return searchFields<T, mid, hi>();
+    } else {
+      return searchFields<T, lo, mid - 1>();
+    }
+  }
+}
+
+// Otherwise fields can only be counted with all of them initialized: T is
+// wrapped next to `total` sinks and given `total` initializers, `n` that do
+// not convert to Sink followed by ones that do. Brace elision spreads them
+// over the fields of T first, so this compiles iff n <= the field count.
+struct Sink {};
+
+template <class T, std::size_t total>
+struct Sinked {
+  T value;
+  Sink sinks[total];
+};
+
+template <class T>
+struct FieldOnly {
+  template <class U>
+    requires(!std::is_same_v<U, T> && !std::is_same_v<U, Sink>)
+  operator U() const noexcept;
+};
+
+template <class T>
+struct FieldOrSink {
+  template <class U>
+    requires(!std::is_same_v<U, T>)
+  operator U() const noexcept;
+};
+
+template <class T, std::size_t n, std::size_t total>
+constexpr bool kFieldsAtLeast =
+    []<std::size_t... is>(std::index_sequence<is...>) {
+      return requires {
+        Sinked<T, total>{
+            std::conditional_t<(is < n), FieldOnly<T>, FieldOrSink<T>>{}...};
+      };
+    }(std::make_index_sequence<total>{});
+
+template <class T, std::size_t lo, std::size_t hi, std::size_t total>
+constexpr std::size_t searchSinkedFields() {
+  if constexpr (lo == hi) {
+    return lo;
+  } else {
+    constexpr std::size_t mid = lo + (hi - lo + 1) / 2;
+    if constexpr (kFieldsAtLeast<T, mid, total>) {
+      return searchSinkedFields<T, mid, hi, total>();
+    } else {
+      return searchSinkedFields<T, lo, mid - 1, total>();
+    }
+  }
+}
+
+inline constexpr std::size_t kMaxBoundFields = 128;
 
-    template <template <class...> class AnnotationTemplate>
-    using FindAnnotation = /* ... */;
+// Counts fields up to kMaxBoundFields + 1, which stands for any larger count
+// and fails bindFields, so neither search grows with sizeof(T). A field takes
+// at least one bit. If not even n = 0 compiles with `kMaxFields` sinks, T has
+// at least `kMaxFields` fields.
+template <class T>
+constexpr std::size_t kRawFieldCount = [] {
+  constexpr std::size_t kMaxFields =
+      std::min(sizeof(T) * CHAR_BIT, kMaxBoundFields + 1);
+  constexpr std::size_t n = searchFields<T, 0, kMaxFields>();
+
+  if constexpr (kInitializableWith<T, n> && !kInitializableWith<T, n + 1>) {
+    return n;
+  } else if constexpr (!kFieldsAtLeast<T, 0, kMaxFields>) {
+    return kMaxFields;
+  } else {
+    return searchSinkedFields<T, 0, kMaxFields, kMaxFields>();
+  }
+}();
+
+// References to fields, each picked out by its index with one overload
+// resolution rather than the recursion of std::tuple.
+template <std::size_t i, class F>
+struct FieldRef {
+  F& ref;
 };
 
+template <class Indices, class... Fs>
+struct FieldRefs;
+
+template <std::size_t... is, class... Fs>
+struct FieldRefs<std::index_sequence<is...>, Fs...> : FieldRef<is, Fs>... {};
+
+template <class... Fs>
+constexpr auto refFields(Fs&... fields) noexcept {
+  return FieldRefs<std::index_sequence_for<Fs...>, Fs...>{{fields}...};
+}
+
+template <std::size_t i, class F>
+constexpr F& pickField(const FieldRef<i, F>& field) noexcept {
+  return field.ref;
+}
+
+// REFLECT_FIELDS_n names n bindings.
+#define REFLECT_FIELDS_1 f0
+#define REFLECT_FIELDS_2 REFLECT_FIELDS_1, f1
+#define REFLECT_FIELDS_3 REFLECT_FIELDS_2, f2
+#define REFLECT_FIELDS_4 REFLECT_FIELDS_3, f3
+#define REFLECT_FIELDS_5 REFLECT_FIELDS_4, f4
+#define REFLECT_FIELDS_6 REFLECT_FIELDS_5, f5
+#define REFLECT_FIELDS_7 REFLECT_FIELDS_6, f6
+#define REFLECT_FIELDS_8 REFLECT_FIELDS_7, f7
+#define REFLECT_FIELDS_9 REFLECT_FIELDS_8, f8
+#define REFLECT_FIELDS_10 REFLECT_FIELDS_9, f9
+#define REFLECT_FIELDS_11 REFLECT_FIELDS_10, f10
+#define REFLECT_FIELDS_12 REFLECT_FIELDS_11, f11
+#define REFLECT_FIELDS_13 REFLECT_FIELDS_12, f12
+#define REFLECT_FIELDS_14 REFLECT_FIELDS_13, f13
+#define REFLECT_FIELDS_15 REFLECT_FIELDS_14, f14
+#define REFLECT_FIELDS_16 REFLECT_FIELDS_15, f15
+#define REFLECT_FIELDS_17 REFLECT_FIELDS_16, f16
+#define REFLECT_FIELDS_18 REFLECT_FIELDS_17, f17
+#define REFLECT_FIELDS_19 REFLECT_FIELDS_18, f18
+#define REFLECT_FIELDS_20 REFLECT_FIELDS_19, f19
+#define REFLECT_FIELDS_21 REFLECT_FIELDS_20, f20
+#define REFLECT_FIELDS_22 REFLECT_FIELDS_21, f21
+#define REFLECT_FIELDS_23 REFLECT_FIELDS_22, f22
+#define REFLECT_FIELDS_24 REFLECT_FIELDS_23, f23
+#define REFLECT_FIELDS_25 REFLECT_FIELDS_24, f24
+#define REFLECT_FIELDS_26 REFLECT_FIELDS_25, f25
+#define REFLECT_FIELDS_27 REFLECT_FIELDS_26, f26
+#define REFLECT_FIELDS_28 REFLECT_FIELDS_27, f27
+#define REFLECT_FIELDS_29 REFLECT_FIELDS_28, f28
+#define REFLECT_FIELDS_30 REFLECT_FIELDS_29, f29
+#define REFLECT_FIELDS_31 REFLECT_FIELDS_30, f30
+#define REFLECT_FIELDS_32 REFLECT_FIELDS_31, f31
+#define REFLECT_FIELDS_33 REFLECT_FIELDS_32, f32
+#define REFLECT_FIELDS_34 REFLECT_FIELDS_33, f33
+#define REFLECT_FIELDS_35 REFLECT_FIELDS_34, f34
+#define REFLECT_FIELDS_36 REFLECT_FIELDS_35, f35
+#define REFLECT_FIELDS_37 REFLECT_FIELDS_36, f36
+#define REFLECT_FIELDS_38 REFLECT_FIELDS_37, f37
+#define REFLECT_FIELDS_39 REFLECT_FIELDS_38, f38
+#define REFLECT_FIELDS_40 REFLECT_FIELDS_39, f39
+#define REFLECT_FIELDS_41 REFLECT_FIELDS_40, f40
+#define REFLECT_FIELDS_42 REFLECT_FIELDS_41, f41
+#define REFLECT_FIELDS_43 REFLECT_FIELDS_42, f42
+#define REFLECT_FIELDS_44 REFLECT_FIELDS_43, f43
+#define REFLECT_FIELDS_45 REFLECT_FIELDS_44, f44
+#define REFLECT_FIELDS_46 REFLECT_FIELDS_45, f45
+#define REFLECT_FIELDS_47 REFLECT_FIELDS_46, f46
+#define REFLECT_FIELDS_48 REFLECT_FIELDS_47, f47
+#define REFLECT_FIELDS_49 REFLECT_FIELDS_48, f48
+#define REFLECT_FIELDS_50 REFLECT_FIELDS_49, f49
+#define REFLECT_FIELDS_51 REFLECT_FIELDS_50, f50
+#define REFLECT_FIELDS_52 REFLECT_FIELDS_51, f51
+#define REFLECT_FIELDS_53 REFLECT_FIELDS_52, f52
+#define REFLECT_FIELDS_54 REFLECT_FIELDS_53, f53
+#define REFLECT_FIELDS_55 REFLECT_FIELDS_54, f54
+#define REFLECT_FIELDS_56 REFLECT_FIELDS_55, f55
+#define REFLECT_FIELDS_57 REFLECT_FIELDS_56, f56
+#define REFLECT_FIELDS_58 REFLECT_FIELDS_57, f57
+#define REFLECT_FIELDS_59 REFLECT_FIELDS_58, f58
+#define REFLECT_FIELDS_60 REFLECT_FIELDS_59, f59
+#define REFLECT_FIELDS_61 REFLECT_FIELDS_60, f60
+#define REFLECT_FIELDS_62 REFLECT_FIELDS_61, f61
+#define REFLECT_FIELDS_63 REFLECT_FIELDS_62, f62
+#define REFLECT_FIELDS_64 REFLECT_FIELDS_63, f63
+#define REFLECT_FIELDS_65 REFLECT_FIELDS_64, f64
+#define REFLECT_FIELDS_66 REFLECT_FIELDS_65, f65
+#define REFLECT_FIELDS_67 REFLECT_FIELDS_66, f66
+#define REFLECT_FIELDS_68 REFLECT_FIELDS_67, f67
+#define REFLECT_FIELDS_69 REFLECT_FIELDS_68, f68
+#define REFLECT_FIELDS_70 REFLECT_FIELDS_69, f69
+#define REFLECT_FIELDS_71 REFLECT_FIELDS_70, f70
+#define REFLECT_FIELDS_72 REFLECT_FIELDS_71, f71
+#define REFLECT_FIELDS_73 REFLECT_FIELDS_72, f72
+#define REFLECT_FIELDS_74 REFLECT_FIELDS_73, f73
+#define REFLECT_FIELDS_75 REFLECT_FIELDS_74, f74
+#define REFLECT_FIELDS_76 REFLECT_FIELDS_75, f75
+#define REFLECT_FIELDS_77 REFLECT_FIELDS_76, f76
+#define REFLECT_FIELDS_78 REFLECT_FIELDS_77, f77
+#define REFLECT_FIELDS_79 REFLECT_FIELDS_78, f78
+#define REFLECT_FIELDS_80 REFLECT_FIELDS_79, f79
+#define REFLECT_FIELDS_81 REFLECT_FIELDS_80, f80
+#define REFLECT_FIELDS_82 REFLECT_FIELDS_81, f81
+#define REFLECT_FIELDS_83 REFLECT_FIELDS_82, f82
+#define REFLECT_FIELDS_84 REFLECT_FIELDS_83, f83
+#define REFLECT_FIELDS_85 REFLECT_FIELDS_84, f84
+#define REFLECT_FIELDS_86 REFLECT_FIELDS_85, f85
+#define REFLECT_FIELDS_87 REFLECT_FIELDS_86, f86
+#define REFLECT_FIELDS_88 REFLECT_FIELDS_87, f87
+#define REFLECT_FIELDS_89 REFLECT_FIELDS_88, f88
+#define REFLECT_FIELDS_90 REFLECT_FIELDS_89, f89
+#define REFLECT_FIELDS_91 REFLECT_FIELDS_90, f90
+#define REFLECT_FIELDS_92 REFLECT_FIELDS_91, f91
+#define REFLECT_FIELDS_93 REFLECT_FIELDS_92, f92
+#define REFLECT_FIELDS_94 REFLECT_FIELDS_93, f93
+#define REFLECT_FIELDS_95 REFLECT_FIELDS_94, f94
+#define REFLECT_FIELDS_96 REFLECT_FIELDS_95, f95
+#define REFLECT_FIELDS_97 REFLECT_FIELDS_96, f96
+#define REFLECT_FIELDS_98 REFLECT_FIELDS_97, f97
+#define REFLECT_FIELDS_99 REFLECT_FIELDS_98, f98
+#define REFLECT_FIELDS_100 REFLECT_FIELDS_99, f99
+#define REFLECT_FIELDS_101 REFLECT_FIELDS_100, f100
+#define REFLECT_FIELDS_102 REFLECT_FIELDS_101, f101
+#define REFLECT_FIELDS_103 REFLECT_FIELDS_102, f102
+#define REFLECT_FIELDS_104 REFLECT_FIELDS_103, f103
+#define REFLECT_FIELDS_105 REFLECT_FIELDS_104, f104
+#define REFLECT_FIELDS_106 REFLECT_FIELDS_105, f105
+#define REFLECT_FIELDS_107 REFLECT_FIELDS_106, f106
+#define REFLECT_FIELDS_108 REFLECT_FIELDS_107, f107
+#define REFLECT_FIELDS_109 REFLECT_FIELDS_108, f108
+#define REFLECT_FIELDS_110 REFLECT_FIELDS_109, f109
+#define REFLECT_FIELDS_111 REFLECT_FIELDS_110, f110
+#define REFLECT_FIELDS_112 REFLECT_FIELDS_111, f111
+#define REFLECT_FIELDS_113 REFLECT_FIELDS_112, f112
+#define REFLECT_FIELDS_114 REFLECT_FIELDS_113, f113
+#define REFLECT_FIELDS_115 REFLECT_FIELDS_114, f114
+#define REFLECT_FIELDS_116 REFLECT_FIELDS_115, f115
+#define REFLECT_FIELDS_117 REFLECT_FIELDS_116, f116
+#define REFLECT_FIELDS_118 REFLECT_FIELDS_117, f117
+#define REFLECT_FIELDS_119 REFLECT_FIELDS_118, f118
+#define REFLECT_FIELDS_120 REFLECT_FIELDS_119, f119
+#define REFLECT_FIELDS_121 REFLECT_FIELDS_120, f120
+#define REFLECT_FIELDS_122 REFLECT_FIELDS_121, f121
+#define REFLECT_FIELDS_123 REFLECT_FIELDS_122, f122
+#define REFLECT_FIELDS_124 REFLECT_FIELDS_123, f123
+#define REFLECT_FIELDS_125 REFLECT_FIELDS_124, f124
+#define REFLECT_FIELDS_126 REFLECT_FIELDS_125, f125
+#define REFLECT_FIELDS_127 REFLECT_FIELDS_126, f126
+#define REFLECT_FIELDS_128 REFLECT_FIELDS_127, f127
+
+#define REFLECT_BIND(n)                                                        \
+  else if constexpr (kCount == n) {                                            \
+    auto& [REFLECT_FIELDS_##n] = object;                                       \
+    return refFields(REFLECT_FIELDS_##n);                                      \
+  }
+
+// References to all fields of `object`, annotations included, from one
+// structured binding with as many names as there are fields.
+template <class T>
+constexpr auto bindFields(T& object) noexcept {
+  constexpr std::size_t kCount = kRawFieldCount<std::remove_const_t<T>>;
+  static_assert(kCount <= kMaxBoundFields,
+                "Describe supports at most 128 fields, annotations included");
+
+  if constexpr (kCount == 0) {
+    static_cast<void>(object);
+    return refFields();
+  }
+  REFLECT_BIND(1) REFLECT_BIND(2) REFLECT_BIND(3) REFLECT_BIND(4)
+  REFLECT_BIND(5) REFLECT_BIND(6) REFLECT_BIND(7) REFLECT_BIND(8)
+  REFLECT_BIND(9) REFLECT_BIND(10) REFLECT_BIND(11) REFLECT_BIND(12)
+  REFLECT_BIND(13) REFLECT_BIND(14) REFLECT_BIND(15) REFLECT_BIND(16)
+  REFLECT_BIND(17) REFLECT_BIND(18) REFLECT_BIND(19) REFLECT_BIND(20)
+  REFLECT_BIND(21) REFLECT_BIND(22) REFLECT_BIND(23) REFLECT_BIND(24)
+  REFLECT_BIND(25) REFLECT_BIND(26) REFLECT_BIND(27) REFLECT_BIND(28)
+  REFLECT_BIND(29) REFLECT_BIND(30) REFLECT_BIND(31) REFLECT_BIND(32)
+  REFLECT_BIND(33) REFLECT_BIND(34) REFLECT_BIND(35) REFLECT_BIND(36)
+  REFLECT_BIND(37) REFLECT_BIND(38) REFLECT_BIND(39) REFLECT_BIND(40)
+  REFLECT_BIND(41) REFLECT_BIND(42) REFLECT_BIND(43) REFLECT_BIND(44)
+  REFLECT_BIND(45) REFLECT_BIND(46) REFLECT_BIND(47) REFLECT_BIND(48)
+  REFLECT_BIND(49) REFLECT_BIND(50) REFLECT_BIND(51) REFLECT_BIND(52)
+  REFLECT_BIND(53) REFLECT_BIND(54) REFLECT_BIND(55) REFLECT_BIND(56)
+  REFLECT_BIND(57) REFLECT_BIND(58) REFLECT_BIND(59) REFLECT_BIND(60)
+  REFLECT_BIND(61) REFLECT_BIND(62) REFLECT_BIND(63) REFLECT_BIND(64)
+  REFLECT_BIND(65) REFLECT_BIND(66) REFLECT_BIND(67) REFLECT_BIND(68)
+  REFLECT_BIND(69) REFLECT_BIND(70) REFLECT_BIND(71) REFLECT_BIND(72)
+  REFLECT_BIND(73) REFLECT_BIND(74) REFLECT_BIND(75) REFLECT_BIND(76)
+  REFLECT_BIND(77) REFLECT_BIND(78) REFLECT_BIND(79) REFLECT_BIND(80)
+  REFLECT_BIND(81) REFLECT_BIND(82) REFLECT_BIND(83) REFLECT_BIND(84)
+  REFLECT_BIND(85) REFLECT_BIND(86) REFLECT_BIND(87) REFLECT_BIND(88)
+  REFLECT_BIND(89) REFLECT_BIND(90) REFLECT_BIND(91) REFLECT_BIND(92)
+  REFLECT_BIND(93) REFLECT_BIND(94) REFLECT_BIND(95) REFLECT_BIND(96)
+  REFLECT_BIND(97) REFLECT_BIND(98) REFLECT_BIND(99) REFLECT_BIND(100)
+  REFLECT_BIND(101) REFLECT_BIND(102) REFLECT_BIND(103) REFLECT_BIND(104)
+  REFLECT_BIND(105) REFLECT_BIND(106) REFLECT_BIND(107) REFLECT_BIND(108)
+  REFLECT_BIND(109) REFLECT_BIND(110) REFLECT_BIND(111) REFLECT_BIND(112)
+  REFLECT_BIND(113) REFLECT_BIND(114) REFLECT_BIND(115) REFLECT_BIND(116)
+  REFLECT_BIND(117) REFLECT_BIND(118) REFLECT_BIND(119) REFLECT_BIND(120)
+  REFLECT_BIND(121) REFLECT_BIND(122) REFLECT_BIND(123) REFLECT_BIND(124)
+  REFLECT_BIND(125) REFLECT_BIND(126) REFLECT_BIND(127) REFLECT_BIND(128)
+}
+
+#undef REFLECT_BIND
+#undef REFLECT_FIELDS_1
+#undef REFLECT_FIELDS_2
+#undef REFLECT_FIELDS_3
+#undef REFLECT_FIELDS_4
+#undef REFLECT_FIELDS_5
+#undef REFLECT_FIELDS_6
+#undef REFLECT_FIELDS_7
+#undef REFLECT_FIELDS_8
+#undef REFLECT_FIELDS_9
+#undef REFLECT_FIELDS_10
+#undef REFLECT_FIELDS_11
+#undef REFLECT_FIELDS_12
+#undef REFLECT_FIELDS_13
+#undef REFLECT_FIELDS_14
+#undef REFLECT_FIELDS_15
+#undef REFLECT_FIELDS_16
+#undef REFLECT_FIELDS_17
+#undef REFLECT_FIELDS_18
+#undef REFLECT_FIELDS_19
+#undef REFLECT_FIELDS_20
+#undef REFLECT_FIELDS_21
+#undef REFLECT_FIELDS_22
+#undef REFLECT_FIELDS_23
+#undef REFLECT_FIELDS_24
+#undef REFLECT_FIELDS_25
+#undef REFLECT_FIELDS_26
+#undef REFLECT_FIELDS_27
+#undef REFLECT_FIELDS_28
+#undef REFLECT_FIELDS_29
+#undef REFLECT_FIELDS_30
+#undef REFLECT_FIELDS_31
+#undef REFLECT_FIELDS_32
+#undef REFLECT_FIELDS_33
+#undef REFLECT_FIELDS_34
+#undef REFLECT_FIELDS_35
+#undef REFLECT_FIELDS_36
+#undef REFLECT_FIELDS_37
+#undef REFLECT_FIELDS_38
+#undef REFLECT_FIELDS_39
+#undef REFLECT_FIELDS_40
+#undef REFLECT_FIELDS_41
+#undef REFLECT_FIELDS_42
+#undef REFLECT_FIELDS_43
+#undef REFLECT_FIELDS_44
+#undef REFLECT_FIELDS_45
+#undef REFLECT_FIELDS_46
+#undef REFLECT_FIELDS_47
+#undef REFLECT_FIELDS_48
+#undef REFLECT_FIELDS_49
+#undef REFLECT_FIELDS_50
+#undef REFLECT_FIELDS_51
+#undef REFLECT_FIELDS_52
+#undef REFLECT_FIELDS_53
+#undef REFLECT_FIELDS_54
+#undef REFLECT_FIELDS_55
+#undef REFLECT_FIELDS_56
+#undef REFLECT_FIELDS_57
+#undef REFLECT_FIELDS_58
+#undef REFLECT_FIELDS_59
+#undef REFLECT_FIELDS_60
+#undef REFLECT_FIELDS_61
+#undef REFLECT_FIELDS_62
+#undef REFLECT_FIELDS_63
+#undef REFLECT_FIELDS_64
+#undef REFLECT_FIELDS_65
+#undef REFLECT_FIELDS_66
+#undef REFLECT_FIELDS_67
+#undef REFLECT_FIELDS_68
+#undef REFLECT_FIELDS_69
+#undef REFLECT_FIELDS_70
+#undef REFLECT_FIELDS_71
+#undef REFLECT_FIELDS_72
+#undef REFLECT_FIELDS_73
+#undef REFLECT_FIELDS_74
+#undef REFLECT_FIELDS_75
+#undef REFLECT_FIELDS_76
+#undef REFLECT_FIELDS_77
+#undef REFLECT_FIELDS_78
+#undef REFLECT_FIELDS_79
+#undef REFLECT_FIELDS_80
+#undef REFLECT_FIELDS_81
+#undef REFLECT_FIELDS_82
+#undef REFLECT_FIELDS_83
+#undef REFLECT_FIELDS_84
+#undef REFLECT_FIELDS_85
+#undef REFLECT_FIELDS_86
+#undef REFLECT_FIELDS_87
+#undef REFLECT_FIELDS_88
+#undef REFLECT_FIELDS_89
+#undef REFLECT_FIELDS_90
+#undef REFLECT_FIELDS_91
+#undef REFLECT_FIELDS_92
+#undef REFLECT_FIELDS_93
+#undef REFLECT_FIELDS_94
+#undef REFLECT_FIELDS_95
+#undef REFLECT_FIELDS_96
+#undef REFLECT_FIELDS_97
+#undef REFLECT_FIELDS_98
+#undef REFLECT_FIELDS_99
+#undef REFLECT_FIELDS_100
+#undef REFLECT_FIELDS_101
+#undef REFLECT_FIELDS_102
+#undef REFLECT_FIELDS_103
+#undef REFLECT_FIELDS_104
+#undef REFLECT_FIELDS_105
+#undef REFLECT_FIELDS_106
+#undef REFLECT_FIELDS_107
+#undef REFLECT_FIELDS_108
+#undef REFLECT_FIELDS_109
+#undef REFLECT_FIELDS_110
+#undef REFLECT_FIELDS_111
+#undef REFLECT_FIELDS_112
+#undef REFLECT_FIELDS_113
+#undef REFLECT_FIELDS_114
+#undef REFLECT_FIELDS_115
+#undef REFLECT_FIELDS_116
+#undef REFLECT_FIELDS_117
+#undef REFLECT_FIELDS_118
+#undef REFLECT_FIELDS_119
+#undef REFLECT_FIELDS_120
+#undef REFLECT_FIELDS_121
+#undef REFLECT_FIELDS_122
+#undef REFLECT_FIELDS_123
+#undef REFLECT_FIELDS_124
+#undef REFLECT_FIELDS_125
+#undef REFLECT_FIELDS_126
+#undef REFLECT_FIELDS_127
+#undef REFLECT_FIELDS_128
+
+template <class T, std::size_t i>
+using RawFieldType = std::remove_reference_t<
+    decltype(pickField<i>(bindFields(std::declval<T&>())))>;
+
+template <class T>
+constexpr bool kReflectable = [] {
+  if constexpr (std::is_class_v<T> && std::is_aggregate_v<T>) {
+    return kRawFieldCount<T> <= kMaxBoundFields;
+  } else {
+    return false;
+  }
+}();
+
+// Position of every field among all fields, annotations included, and where
+// its annotations start.
+template <std::size_t n>
+struct FieldLayout {
+  std::size_t num_fields = 0;
+  std::array<std::size_t, n> raw_index{};
+  std::array<std::size_t, n> annotations_begin{};
+};
+
+template <class T>
+constexpr auto kFieldLayout =
+    []<std::size_t... is>(std::index_sequence<is...>) {
+      constexpr std::size_t n = sizeof...(is);
+      constexpr std::array<bool, n> is_annotation = {
+          IsAnnotate<RawFieldType<T, is>>::value...};
+
+      FieldLayout<n> layout;
+      std::size_t begin = 0;
+      for (std::size_t i = 0; i < n; ++i) {
+        if (!is_annotation[i]) {
+          layout.raw_index[layout.num_fields] = i;
+          layout.annotations_begin[layout.num_fields] = begin;
+          ++layout.num_fields;
+          begin = i + 1;
+        }
+      }
+      return layout;
+    }(std::make_index_sequence<kRawFieldCount<T>>{});
+
+template <class... As>
+struct AnnotationList {
+  using Type = Annotate<As...>;
+
+  template <class... Bs>
+  friend AnnotationList<As..., Bs...> operator+(AnnotationList,
+                                                Annotate<Bs...>);
+};
+
+template <class T, std::size_t begin, std::size_t... is>
+auto concatAnnotations(std::index_sequence<is...>)
+    -> decltype((AnnotationList<>{} + ... +
+                 RawFieldType<T, begin + is>{}));
+
+template <class Annotations>
+struct AnnotationQuery;
+
+template <class... As>
+struct AnnotationQuery<Annotate<As...>> {
+  template <template <class...> class Template>
+  static constexpr std::size_t kFirst = [] {
+    constexpr std::array<bool, sizeof...(As)> matches = {
+        IsSpecializationOf<As, Template>::value...};
+
+    std::size_t j = 0;
+    while (j < sizeof...(As) && !matches[j]) {
+      ++j;
+    }
+    return j;
+  }();
+
+  template <template <class...> class Template>
+  static constexpr bool kHasTemplate = kFirst<Template> < sizeof...(As);
+
+  template <class Annotation>
+  static constexpr bool kHasClass = (std::is_same_v<Annotation, As> || ...);
+
+  template <template <class...> class Template>
+  using Find = std::tuple_element_t<kFirst<Template>, std::tuple<As...>>;
+};
+
+template <class T, std::size_t i>
+struct FieldDescriptor {
+ private:
+  static constexpr std::size_t kRawIndex = kFieldLayout<T>.raw_index[i];
+  static constexpr std::size_t kAnnotationsBegin =
+      kFieldLayout<T>.annotations_begin[i];
+
+ public:
+  using Type = RawFieldType<T, kRawIndex>;
+
+  using Annotations =
+      typename decltype(concatAnnotations<T, kAnnotationsBegin>(
+          std::make_index_sequence<kRawIndex - kAnnotationsBegin>{}))::Type;
+
+  template <template <class...> class AnnotationTemplate>
+  static constexpr bool has_annotation_template =
+      AnnotationQuery<Annotations>::template kHasTemplate<AnnotationTemplate>;
+
+  template <class Annotation>
+  static constexpr bool has_annotation_class =
+      AnnotationQuery<Annotations>::template kHasClass<Annotation>;
+
+  // The first annotation that is a specialization of AnnotationTemplate.
+  template <template <class...> class AnnotationTemplate>
+    requires has_annotation_template<AnnotationTemplate>
+  using FindAnnotation =
+      typename AnnotationQuery<Annotations>::template Find<AnnotationTemplate>;
+
+  static constexpr Type& get(T& object) noexcept {
+    return pickField<kRawIndex>(bindFields(object));
+  }
+
+  static constexpr const Type& get(const T& object) noexcept {
+    return pickField<kRawIndex>(bindFields(object));
+  }
+};
+
+}  // namespace detail
+
 template <class T>
 struct Describe {
-    static constexpr std::size_t num_fields = /* number of fields */
-    
-    template <std::size_t I>
-    using Field = /* field descriptor */;
+  static constexpr std::size_t num_fields =
+      detail::kFieldLayout<T>.num_fields;
+
+  template <std::size_t I>
+    requires(I < num_fields)
+  using Field = detail::FieldDescriptor<T, I>;
 };
@@ -0,0 +1,578 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <reflect.hpp>
+
+// Binary encoding of reflected aggregates. Fields go in declaration order in
+// native byte order with no padding; annotations are skipped. Arithmetic
+// types and enums take their object representation, aggregates and
+// std::array the encodings of their elements, and strings and sequences a
+// std::uint32_t length followed by the elements. Elements of a sequence of
+// packed types (scalars and aggregates of them without padding) start at a
+// multiple of their alignment from the beginning of the buffer, so that they
+// can be used in place.
+//
+// Consecutive packed fields adjacent in memory are copied as one block.
+// deserialize() points std::string_view and std::span<const U> fields into
+// the input, which must outlive the result and, for std::span fields, be
+// aligned to max_align_t; std::string and std::vector fields are copies and
+// read from any input. Each pair has the same encoding, so a message written
+// with one can be read with the other. Bools encoded as anything but 0 or 1
+// fail to deserialize.
+
+namespace detail {
+
+enum class EncodingKind {
+  kUnsupported,
+  kScalar,
+  kString,
+  kStringView,
+  kSpan,
+  kVector,
+  kArray,
+  kAggregate,
+};
+
+template <class F>
+struct EncodingKindOf {
+  static constexpr EncodingKind kValue = [] {
+    if constexpr (std::is_arithmetic_v<F> || std::is_enum_v<F>) {
+      return EncodingKind::kScalar;
+    } else if constexpr (kReflectable<F>) {
+      return EncodingKind::kAggregate;
+    } else {
+      return EncodingKind::kUnsupported;
+    }
+  }();
+};
+
+template <class Traits, class Allocator>
+struct EncodingKindOf<std::basic_string<char, Traits, Allocator>> {
+  static constexpr EncodingKind kValue = EncodingKind::kString;
+};
+
+template <>
+struct EncodingKindOf<std::string_view> {
+  static constexpr EncodingKind kValue = EncodingKind::kStringView;
+};
+
+template <class U>
+struct EncodingKindOf<std::span<const U>> {
+  static constexpr EncodingKind kValue = EncodingKind::kSpan;
+};
+
+template <class U, class Allocator>
+struct EncodingKindOf<std::vector<U, Allocator>> {
+  static constexpr EncodingKind kValue = EncodingKind::kVector;
+};
+
+template <class U, std::size_t n>
+struct EncodingKindOf<std::array<U, n>> {
+  static constexpr EncodingKind kValue = EncodingKind::kArray;
+};
+
+template <class F>
+constexpr EncodingKind kEncodingKind = EncodingKindOf<F>::kValue;
+
+template <class T, std::size_t i>
+using DescribedType = typename Describe<T>::template Field<i>::Type;
+
+// Encoded exactly as its object representation.
+template <class F>
+constexpr bool kPacked = [] {
+  if constexpr (kEncodingKind<F> == EncodingKind::kScalar) {
+    return true;
+  } else if constexpr (kEncodingKind<F> == EncodingKind::kArray) {
+    return kPacked<typename F::value_type>;
+  } else if constexpr (kEncodingKind<F> == EncodingKind::kAggregate) {
+    if constexpr (!std::is_trivially_copyable_v<F>) {
+      return false;
+    } else {
+      return []<std::size_t... is>(std::index_sequence<is...>) {
+        return (kPacked<DescribedType<F, is>> && ...) &&
+               (sizeof(DescribedType<F, is>) + ... + 0) == sizeof(F);
+      }(std::make_index_sequence<Describe<F>::num_fields>{});
+    }
+  } else {
+    return false;
+  }
+}();
+
+template <class F>
+constexpr bool kEncodable = [] {
+  constexpr auto kind = kEncodingKind<F>;
+
+  if constexpr (kind == EncodingKind::kSpan) {
+    return kPacked<typename F::value_type>;
+  } else if constexpr (kind == EncodingKind::kVector) {
+    // std::vector<bool> has no data() to encode from.
+    return !std::is_same_v<typename F::value_type, bool> &&
+           kEncodable<typename F::value_type>;
+  } else if constexpr (kind == EncodingKind::kArray) {
+    return kEncodable<typename F::value_type>;
+  } else if constexpr (kind == EncodingKind::kAggregate) {
+    return []<std::size_t... is>(std::index_sequence<is...>) {
+      return (kEncodable<DescribedType<F, is>> && ...);
+    }(std::make_index_sequence<Describe<F>::num_fields>{});
+  } else {
+    return kind != EncodingKind::kUnsupported;
+  }
+}();
+
+// Whether packed F holds a bool, whose bytes other than 0 and 1 are not
+// valid values.
+template <class F>
+constexpr bool kHasBool = [] {
+  if constexpr (std::is_same_v<F, bool>) {
+    return true;
+  } else if constexpr (kEncodingKind<F> == EncodingKind::kArray) {
+    return kHasBool<typename F::value_type>;
+  } else if constexpr (kEncodingKind<F> == EncodingKind::kAggregate) {
+    return []<std::size_t... is>(std::index_sequence<is...>) {
+      return (kHasBool<DescribedType<F, is>> || ...);
+    }(std::make_index_sequence<Describe<F>::num_fields>{});
+  } else {
+    return false;
+  }
+}();
+
+// Looks at the bytes of the bools in packed `value` only, so it may be
+// called on a value copied from untrusted input.
+template <class F>
+bool boolsValid(const F& value) noexcept {
+  if constexpr (!kHasBool<F>) {
+    return true;
+  } else if constexpr (std::is_same_v<F, bool>) {
+    unsigned char byte;
+    std::memcpy(&byte, &value, sizeof(byte));
+    return byte <= 1;
+  } else if constexpr (kEncodingKind<F> == EncodingKind::kArray) {
+    return std::all_of(value.begin(), value.end(),
+                       [](const auto& element) { return boolsValid(element); });
+  } else {
+    return []<std::size_t... is>(const F& value, std::index_sequence<is...>) {
+      return (boolsValid(Describe<F>::template Field<is>::get(value)) && ...);
+    }(value, std::make_index_sequence<Describe<F>::num_fields>{});
+  }
+}
+
+// Fields [first, last) of an aggregate, either packed or a single field
+// encoded on its own.
+struct FieldRun {
+  std::size_t first = 0;
+  std::size_t last = 0;
+  bool packed = false;
+};
+
+template <class T>
+struct FieldRuns {
+  std::array<FieldRun, Describe<T>::num_fields> runs{};
+  std::size_t count = 0;
+};
+
+template <class T>
+constexpr auto kFieldRuns = []<std::size_t... is>(std::index_sequence<is...>) {
+  constexpr std::array<bool, sizeof...(is)> packed = {
+      kPacked<DescribedType<T, is>>...};
+
+  FieldRuns<T> result;
+  for (std::size_t i = 0; i < sizeof...(is); ++i) {
+    if (result.count > 0 && packed[i] && result.runs[result.count - 1].packed) {
+      ++result.runs[result.count - 1].last;
+    } else {
+      result.runs[result.count++] = {i, i + 1, packed[i]};
+    }
+  }
+  return result;
+}(std::make_index_sequence<Describe<T>::num_fields>{});
+
+template <class T, std::size_t r>
+constexpr std::size_t kRunSize =
+    []<std::size_t... is>(std::index_sequence<is...>) {
+      return (sizeof(DescribedType<T, kFieldRuns<T>.runs[r].first + is>) +
+              ... + 0);
+    }(std::make_index_sequence<kFieldRuns<T>.runs[r].last -
+                               kFieldRuns<T>.runs[r].first>{});
+
+// The bytes of run r if its fields are adjacent in memory, which is the case
+// unless alignment leaves gaps between them; the check then folds away.
+template <std::size_t r, class T>
+auto* runBytes(T& value) noexcept {
+  using U = std::remove_const_t<T>;
+  using Byte =
+      std::conditional_t<std::is_const_v<T>, const std::byte, std::byte>;
+  constexpr auto run = kFieldRuns<U>.runs[r];
+
+  auto* first = reinterpret_cast<Byte*>(
+      std::addressof(Describe<U>::template Field<run.first>::get(value)));
+  auto* last = reinterpret_cast<Byte*>(
+      std::addressof(Describe<U>::template Field<run.last - 1>::get(value)));
+  auto size = static_cast<std::size_t>(
+      last + sizeof(DescribedType<U, run.last - 1>) - first);
+  return size == kRunSize<U, r> ? first : nullptr;
+}
+
+constexpr std::size_t paddingFor(std::size_t position, std::size_t alignment) {
+  return (alignment - position % alignment) % alignment;
+}
+
+class ByteCounter {
+ public:
+  bool write(const void*, std::size_t size) noexcept {
+    size_ += size;
+    return true;
+  }
+
+  bool align(std::size_t alignment) noexcept {
+    size_ += paddingFor(size_, alignment);
+    return true;
+  }
+
+  std::size_t size() const noexcept {
+    return size_;
+  }
+
+ private:
+  std::size_t size_ = 0;
+};
+
+class ByteWriter {
+ public:
+  explicit ByteWriter(std::span<std::byte> out) noexcept : out_(out) {
+  }
+
+  bool write(const void* data, std::size_t size) noexcept {
+    if (size > out_.size() - size_) {
+      return false;
+    }
+    if (size > 0) {
+      std::memcpy(out_.data() + size_, data, size);
+    }
+    size_ += size;
+    return true;
+  }
+
+  bool align(std::size_t alignment) noexcept {
+    auto padding = paddingFor(size_, alignment);
+    if (padding > out_.size() - size_) {
+      return false;
+    }
+    if (padding > 0) {
+      std::memset(out_.data() + size_, 0, padding);
+    }
+    size_ += padding;
+    return true;
+  }
+
+  std::size_t size() const noexcept {
+    return size_;
+  }
+
+ private:
+  std::span<std::byte> out_;
+  std::size_t size_ = 0;
+};
+
+class ByteReader {
+ public:
+  explicit ByteReader(std::span<const std::byte> in) noexcept : in_(in) {
+  }
+
+  // The next `size` bytes, or nullptr if there are fewer.
+  const std::byte* take(std::size_t size) noexcept {
+    if (size > left()) {
+      return nullptr;
+    }
+    return in_.data() + std::exchange(position_, position_ + size);
+  }
+
+  bool read(void* data, std::size_t size) noexcept {
+    const auto* bytes = take(size);
+    if (bytes != nullptr && size > 0) {
+      std::memcpy(data, bytes, size);
+    }
+    return bytes != nullptr;
+  }
+
+  bool align(std::size_t alignment) noexcept {
+    return take(paddingFor(position_, alignment)) != nullptr;
+  }
+
+  std::size_t left() const noexcept {
+    return in_.size() - position_;
+  }
+
+ private:
+  std::span<const std::byte> in_;
+  std::size_t position_ = 0;
+};
+
+template <class Out>
+bool encodeLength(Out& out, std::size_t length) {
+  if (length > std::numeric_limits<std::uint32_t>::max()) {
+    return false;
+  }
+  auto encoded = static_cast<std::uint32_t>(length);
+  return out.write(&encoded, sizeof(encoded));
+}
+
+inline std::optional<std::size_t> decodeLength(ByteReader& in) {
+  std::uint32_t length;
+  if (!in.read(&length, sizeof(length))) {
+    return std::nullopt;
+  }
+  return length;
+}
+
+template <class Out, class F>
+bool encode(Out& out, const F& value);
+
+template <class F>
+bool decode(ByteReader& in, F& value);
+
+template <class Out, class U>
+bool encodeElements(Out& out, const U* data, std::size_t size) {
+  if constexpr (kPacked<U>) {
+    return out.write(data, size * sizeof(U));
+  } else {
+    for (std::size_t i = 0; i < size; ++i) {
+      if (!encode(out, data[i])) {
+        return false;
+      }
+    }
+    return true;
+  }
+}
+
+template <class Out, class U>
+bool encodeSequence(Out& out, const U* data, std::size_t size) {
+  if (!encodeLength(out, size)) {
+    return false;
+  }
+  if constexpr (kPacked<U>) {
+    if (!out.align(alignof(U))) {
+      return false;
+    }
+  }
+  return encodeElements(out, data, size);
+}
+
+// The length of a sequence of packed U, leaving `in` at its first element.
+template <class U>
+std::optional<std::size_t> decodePackedLength(ByteReader& in) {
+  auto size = decodeLength(in);
+  if (!size || !in.align(alignof(U)) || *size > in.left() / sizeof(U)) {
+    return std::nullopt;
+  }
+  return size;
+}
+
+// The elements of a sequence of packed U, in place, which needs the input
+// to be aligned.
+template <class U>
+std::optional<std::span<const U>> decodePackedView(ByteReader& in) {
+  auto size = decodePackedLength<U>(in);
+  const auto* bytes = size ? in.take(*size * sizeof(U)) : nullptr;
+  if (bytes == nullptr ||
+      reinterpret_cast<std::uintptr_t>(bytes) % alignof(U) != 0) {
+    return std::nullopt;
+  }
+
+  std::span elements(reinterpret_cast<const U*>(bytes), *size);
+  if (!std::all_of(elements.begin(), elements.end(),
+                   [](const U& element) { return boolsValid(element); })) {
+    return std::nullopt;
+  }
+  return elements;
+}
+
+template <class Out, class T>
+bool encodeFields(Out& out, const T& value) {
+  auto encodeField =
+      [&]<std::size_t i>(std::integral_constant<std::size_t, i>) {
+        return encode(out, Describe<T>::template Field<i>::get(value));
+      };
+
+  return [&]<std::size_t... rs>(std::index_sequence<rs...>) {
+    return ([&] {
+      constexpr auto run = kFieldRuns<T>.runs[rs];
+      if constexpr (run.packed) {
+        if (const auto* bytes = runBytes<rs>(value)) {
+          return out.write(bytes, kRunSize<T, rs>);
+        }
+      }
+      return [&]<std::size_t... is>(std::index_sequence<is...>) {
+        return (encodeField(std::integral_constant<std::size_t,
+                                                   run.first + is>{}) &&
+                ...);
+      }(std::make_index_sequence<run.last - run.first>{});
+    }() && ...);
+  }(std::make_index_sequence<kFieldRuns<T>.count>{});
+}
+
+template <class T>
+bool decodeFields(ByteReader& in, T& value) {
+  auto decodeField =
+      [&]<std::size_t i>(std::integral_constant<std::size_t, i>) {
+        return decode(in, Describe<T>::template Field<i>::get(value));
+      };
+
+  auto runValid = [&]<std::size_t first, std::size_t... is>(
+                      std::integral_constant<std::size_t, first>,
+                      std::index_sequence<is...>) {
+    return (boolsValid(Describe<T>::template Field<first + is>::get(value)) &&
+            ...);
+  };
+
+  return [&]<std::size_t... rs>(std::index_sequence<rs...>) {
+    return ([&] {
+      constexpr auto run = kFieldRuns<T>.runs[rs];
+      if constexpr (run.packed) {
+        if (auto* bytes = runBytes<rs>(value)) {
+          return in.read(bytes, kRunSize<T, rs>) &&
+                 runValid(std::integral_constant<std::size_t, run.first>{},
+                          std::make_index_sequence<run.last - run.first>{});
+        }
+      }
+      return [&]<std::size_t... is>(std::index_sequence<is...>) {
+        return (decodeField(std::integral_constant<std::size_t,
+                                                   run.first + is>{}) &&
+                ...);
+      }(std::make_index_sequence<run.last - run.first>{});
+    }() && ...);
+  }(std::make_index_sequence<kFieldRuns<T>.count>{});
+}
+
+template <class Out, class F>
+bool encode(Out& out, const F& value) {
+  constexpr auto kind = kEncodingKind<F>;
+
+  if constexpr (kPacked<F>) {
+    return out.write(std::addressof(value), sizeof(F));
+  } else if constexpr (kind == EncodingKind::kString ||
+                       kind == EncodingKind::kStringView ||
+                       kind == EncodingKind::kSpan ||
+                       kind == EncodingKind::kVector) {
+    return encodeSequence(out, value.data(), value.size());
+  } else if constexpr (kind == EncodingKind::kArray) {
+    return encodeElements(out, value.data(), value.size());
+  } else {
+    return encodeFields(out, value);
+  }
+}
+
+template <class F>
+bool decode(ByteReader& in, F& value) {
+  constexpr auto kind = kEncodingKind<F>;
+
+  if constexpr (kPacked<F>) {
+    return in.read(std::addressof(value), sizeof(F)) && boolsValid(value);
+  } else if constexpr (kind == EncodingKind::kString ||
+                       kind == EncodingKind::kStringView) {
+    auto size = decodeLength(in);
+    const auto* bytes = size ? in.take(*size) : nullptr;
+    if (bytes == nullptr) {
+      return false;
+    }
+    value = F(reinterpret_cast<const char*>(bytes), *size);
+    return true;
+  } else if constexpr (kind == EncodingKind::kSpan) {
+    auto elements = decodePackedView<typename F::value_type>(in);
+    if (elements) {
+      value = *elements;
+    }
+    return elements.has_value();
+  } else if constexpr (kind == EncodingKind::kVector) {
+    using U = typename F::value_type;
+
+    if constexpr (kPacked<U>) {
+      auto size = decodePackedLength<U>(in);
+      if (!size) {
+        return false;
+      }
+      value.resize(*size);
+      return in.read(value.data(), *size * sizeof(U)) &&
+             std::all_of(value.begin(), value.end(),
+                         [](const U& element) { return boolsValid(element); });
+    } else {
+      auto size = decodeLength(in);
+      if (!size) {
+        return false;
+      }
+      value.clear();
+      value.reserve(std::min(*size, in.left()));
+      for (std::size_t i = 0; i < *size; ++i) {
+        if (!decode(in, value.emplace_back())) {
+          return false;
+        }
+      }
+      return true;
+    }
+  } else if constexpr (kind == EncodingKind::kArray) {
+    for (auto& element : value) {
+      if (!decode(in, element)) {
+        return false;
+      }
+    }
+    return true;
+  } else {
+    return decodeFields(in, value);
+  }
+}
+
+}  // namespace detail
+
+template <class T>
+concept BinarySerializable = detail::kEncodable<T>;
+
+template <BinarySerializable T>
+std::size_t serializedSize(const T& value) {
+  detail::ByteCounter counter;
+  detail::encode(counter, value);
+  return counter.size();
+}
+
+// Bytes written, or std::nullopt if `buffer` is too small or a length does
+// not fit into std::uint32_t.
+template <BinarySerializable T>
+std::optional<std::size_t> serialize(const T& value,
+                                     std::span<std::byte> buffer) {
+  detail::ByteWriter writer(buffer);
+  if (!detail::encode(writer, value)) {
+    return std::nullopt;
+  }
+  return writer.size();
+}
+
+template <BinarySerializable T>
+std::vector<std::byte> serialize(const T& value) {
+  std::vector<std::byte> buffer(serializedSize(value));
+  serialize(value, std::span(buffer));
+  return buffer;
+}
+
+// std::nullopt unless `buffer` holds exactly one encoded T.
+template <BinarySerializable T>
+  requires std::default_initializable<T>
+std::optional<T> deserialize(std::span<const std::byte> buffer) {
+  std::optional<T> value(std::in_place);
+  detail::ByteReader reader(buffer);
+  if (!detail::decode(reader, *value) || reader.left() != 0) {
+    return std::nullopt;
+  }
+  return value;
+}